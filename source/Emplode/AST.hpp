@@ -17,91 +17,164 @@
 
 #include "Symbol.hpp"
 #include "SymbolTableBase.hpp"
+#include "Value.hpp"
+#include <atomic>
+#include <bit>
 #include <optional>
+#include <string>
+#include <utility>
 #include <variant>
 
 namespace emplode {
-  /// A variable representing a shared mutable reference to a Symbol
+  /// A variable representing a shared mutable reference to a Symbol.
+  ///
+  /// All copies of a Var refer to a single slot, allocated once, that holds either the symbol
+  /// (owned by the slot) or the get/set functions of a linked variable.  Reference counts are
+  /// not atomic: a Var and its copies must only be used from one thread at a time, unless the
+  /// slot has been marked as shared (see SetShared()).
   class Var {
   private:
-    using symbol_ptr_t = std::shared_ptr<emp::Ptr<Symbol>>;
-    using funs_ptr_t = std::shared_ptr<std::pair<std::function<emp::Ptr<Symbol>()>, std::function<void(emp::Ptr<Symbol>)>>>;
-
-    /// A pointer to a pointer so that we can update the value to any type of symbol
-    /// The inner pointer is not shared, though - it's owned by this variable
-    std::variant<
-      symbol_ptr_t,
-      funs_ptr_t
-    > ptr;
-
-    template<typename T, typename U> auto map(T var, U funs) {
-      if (std::holds_alternative<symbol_ptr_t>(ptr)) {
-        return var(std::get<symbol_ptr_t>(ptr));
-      } else {
-        return funs(std::get<funs_ptr_t>(ptr));
+    struct Slot {
+      uint32_t ref_count = 1;              ///< Number of Vars using this slot.
+      bool is_linked = false;              ///< Is this a LinkedSlot?
+      bool is_shared = false;              ///< May copies be made from several threads?
+      emp::Ptr<Symbol> symbol = nullptr;   ///< Owned value (if not linked).
+    };
+
+    /// Linked variables keep their functions in the same allocation as the slot; the function
+    /// types are erased through plain function pointers so unlinked slots need no vtable.
+    struct LinkedSlot : public Slot {
+      emp::Ptr<Symbol> (*get)(const LinkedSlot &) = nullptr;
+      void (*set)(LinkedSlot &, emp::Ptr<Symbol>) = nullptr;
+      void (*free)(emp::Ptr<LinkedSlot>) = nullptr;
+    };
+
+    template <typename GET_T, typename SET_T>
+    struct LinkedSlotImpl : public LinkedSlot {
+      GET_T get_fun;
+      SET_T set_fun;
+
+      LinkedSlotImpl(GET_T && _get, SET_T && _set)
+        : get_fun(std::move(_get)), set_fun(std::move(_set))
+      {
+        is_linked = true;
+        get = [](const LinkedSlot & slot) {
+          return static_cast<const LinkedSlotImpl &>(slot).get_fun();
+        };
+        set = [](LinkedSlot & slot, emp::Ptr<Symbol> value) {
+          static_cast<LinkedSlotImpl &>(slot).set_fun(value);
+        };
+        free = [](emp::Ptr<LinkedSlot> slot) {
+          slot.template StaticCast<LinkedSlotImpl>().Delete();
+        };
+      }
+    };
+
+    emp::Ptr<Slot> slot;
+
+    emp::Ptr<LinkedSlot> AsLinked() const { return slot.StaticCast<LinkedSlot>(); }
+
+    void AddRef() {
+      if (slot->is_shared) [[unlikely]] {
+        std::atomic_ref(slot->ref_count).fetch_add(1, std::memory_order_relaxed);
       }
+      else ++slot->ref_count;
     }
-    template<typename T, typename U> auto map(T var, U funs) const {
-      if (std::holds_alternative<symbol_ptr_t>(ptr)) {
-        return var(std::get<symbol_ptr_t>(ptr));
-      } else {
-        return funs(std::get<funs_ptr_t>(ptr));
+
+    /// Drop one reference; return whether it was the last.
+    bool DropRef() {
+      if (slot->is_shared) [[unlikely]] {
+        return std::atomic_ref(slot->ref_count).fetch_sub(1, std::memory_order_acq_rel) == 1;
       }
+      return --slot->ref_count == 0;
+    }
+
+    void Release() {
+      if (slot && DropRef()) {
+        if (slot->is_linked) AsLinked()->free(AsLinked());
+        else {
+          slot->symbol.Delete();
+          slot.Delete();
+        }
+      }
+      slot = nullptr;
     }
 
   public:
     /// Takes ownership of `initial_value`
-    Var(emp::Ptr<Symbol> initial_value) : ptr(std::make_shared<emp::Ptr<Symbol>>(initial_value)) {
-      (*std::get<symbol_ptr_t>(ptr))->SetTemporary(false);
-    }
-    Var(std::function<emp::Ptr<Symbol>()> get, std::function<void(emp::Ptr<Symbol>)> set)
-      : ptr(std::make_shared<std::pair<std::function<emp::Ptr<Symbol>()>, std::function<void(emp::Ptr<Symbol>)>>>(std::make_pair(get, set))) {}
-
-    ~Var() {
-      map(
-        [](auto &ptr) {
-          if (ptr.use_count() == 1) {
-            ptr->Delete();
-          }
-        },
-        [](auto &ptr) {}
-      );
+    Var(emp::Ptr<Symbol> initial_value) : slot(emp::NewPtr<Slot>()) {
+      slot->symbol = initial_value;
+      initial_value->SetTemporary(false);
+    }
+
+    /// Link to a value through get and set functions.
+    template <typename GET_T, typename SET_T>
+    Var(GET_T get, SET_T set)
+      : slot(emp::NewPtr<LinkedSlotImpl<GET_T,SET_T>>(std::move(get), std::move(set))) { }
+
+    Var(const Var & in) : slot(in.slot) { AddRef(); }
+    Var(Var && in) noexcept : slot(in.slot) { in.slot = nullptr; }
+    ~Var() { Release(); }
+
+    Var & operator=(const Var & in) {
+      if (in.slot == slot) return *this;
+      Release();
+      slot = in.slot;
+      AddRef();
+      return *this;
+    }
+
+    Var & operator=(Var && in) noexcept {
+      if (&in == this) return *this;
+      Release();
+      slot = in.slot;
+      in.slot = nullptr;
+      return *this;
     }
 
+    /// Allow copies of this variable to be made and released from several threads at once
+    /// (such as for the shared BuiltinLibrary); must be set before the variable is shared.
+    void SetShared() { slot->is_shared = true; }
+    bool IsShared() const { return slot->is_shared; }
+
+    /// Is this variable linked to external get/set functions (rather than holding a symbol)?
+    bool IsLinked() const { return slot->is_linked; }
+
+    /// Identifies the variable; all copies of a Var share the same ID.
+    uintptr_t GetID() const { return reinterpret_cast<uintptr_t>(slot.Raw()); }
+
     emp::Ptr<Symbol> GetValue() const {
-      return map(
-        [](auto &ptr) {
-          return *ptr;
-        },
-        [](auto &funs) {
-          return funs->first();
-        }
-      );
+      if (!slot->is_linked) return slot->symbol;
+      return AsLinked()->get(*AsLinked());
     }
 
     /// Takes ownership of `value`
     void SetValue(emp::Ptr<Symbol> value) {
-      return map(
-        [&](auto &ptr) {
-          ptr->Delete();
-          *ptr = value;
-          (*ptr)->SetTemporary(false);
-        },
-        [&](auto &funs) {
-          funs->second(value);
-        }
-      );
+      if (slot->is_linked) {
+        AsLinked()->set(*AsLinked(), value);
+        return;
+      }
+      slot->symbol.Delete();
+      slot->symbol = value;
+      value->SetTemporary(false);
     }
   };
 
   class LValue {
   private:
     std::variant<emp::Ptr<emp::Ptr<Symbol>>, Var> ptr;
+    Value base;   ///< Temporary that holds the referenced symbol (if any), kept alive here.
 
   public:
     LValue(emp::Ptr<emp::Ptr<Symbol>> ptr) : ptr(ptr) {}
     LValue(Var &var) : ptr(var) {}
 
+    /// Keep the temporary that contains this location alive for as long as it is in use.
+    LValue & SetBase(Value && in_base) { base = std::move(in_base); return *this; }
+
+    /// Produce the current value, handing over the base so that it stays valid.
+    Value TakeValue() { return Value(GetValue(), std::move(base)); }
+
     emp::Ptr<Symbol> GetValue() const {
       if (std::holds_alternative<emp::Ptr<emp::Ptr<Symbol>>>(ptr)) {
         return *std::get<0>(ptr);
@@ -155,33 +228,38 @@ namespace emplode {
 
     virtual size_t GetNumChildren() const { return 0; }
     virtual node_ptr_t GetChild(size_t /* id */) { emp_assert(false); return nullptr; }
+    virtual void SetChild(size_t /* id */, node_ptr_t /* child */) { emp_assert(false); }
     node_ptr_t GetParent() { return parent; }
     void SetParent(node_ptr_t in_parent) { parent = in_parent; }
     virtual emp::Ptr<Symbol_Scope> GetScope() { return parent ? parent->GetScope() : nullptr; }
     virtual SymbolTableBase & GetSymbolTable() { return parent->GetSymbolTable(); }
 
-    virtual symbol_ptr_t Process() = 0;
+    /// Evaluate this node; the returned Value cleans up any temporary result.
+    virtual Value Process() = 0;
     virtual std::optional<LValue> AsLValue() { return {}; }
 
+    // Information for optimization passes (see Optimizer.hpp)
+
+    /// If this node (apart from its children) is pure, append a tag identifying its operation
+    /// and return true; pure nodes have no side effects and do not build new objects.
+    virtual bool AppendKey(std::string & /* key */) const { return false; }
+    virtual bool IsLValueChild(size_t /* id */) const { return false; } // Child used as location?
+    virtual bool RunsAfterChildren() const { return false; } // Act only once children are done?
+
     virtual void Write(std::ostream & /* os */=std::cout,
                        const std::string & /* offset */="") const { }
 
     // Helper alternatives for Process()
 
-    /// Run process and clean up any returned symbols automatically, as needed.
-    void ProcessVoid() {
-      symbol_ptr_t out = Process();
-      if (out && out->IsTemporary()) out.Delete();
-    }
+    /// Run process, discarding the result.
+    void ProcessVoid() { Process(); }
 
-    /// Run process, convert the return value to a double, and clean up the symbol if needed.
+    /// Run process and convert the return value to the requested type.
     template <typename T>
     T ProcessAs() {
-      symbol_ptr_t symbol_ptr = Process();                // Run process, collecting the result.
-      if (!symbol_ptr) return T();                        // Any non value will return a zero.
-      T result = symbol_ptr->As<T>();                     // Convert the result to the return type.
-      if (symbol_ptr->IsTemporary()) symbol_ptr.Delete(); // If we are done with input; delete the symbol!
-      return result;
+      Value result = Process();                           // Run process, collecting the result.
+      if (!result) return T();                            // Any non value will return a zero.
+      return result->As<T>();                             // Convert the result to the return type.
     }
 
     virtual void PrintAST(std::ostream & os=std::cout, size_t indent=0) = 0;
@@ -210,6 +288,15 @@ namespace emplode {
       children.push_back(child);
       child->SetParent(this);
     }
+
+    /// Replace a child; the caller is responsible for the old child.
+    void SetChild(size_t id, node_ptr_t child) override {
+      children[id] = child;
+      child->SetParent(this);
+    }
+
+    /// Remove all children; the caller is responsible for them.
+    node_vector_t TakeChildren() { return std::exchange(children, node_vector_t{}); }
   };
 
   class ASTNode_Var : public ASTNode {
@@ -225,6 +312,7 @@ namespace emplode {
     }
 
     const std::string & GetName() const override { return name; }
+    const Var & GetVar() const { return var; }
     Symbol & GetSymbol() const { return *var.GetValue(); }
 
     bool IsNumeric() const override { return GetSymbol().IsNumeric(); }
@@ -235,11 +323,31 @@ namespace emplode {
 
     bool IsLeaf() const override { return true; }
 
+    /// Does this variable refer to a built-in function (which can never be reassigned)?
+    bool IsBuiltinFunction() const {
+      if (var.IsLinked()) return false;   // Linked variables are never functions.
+      return GetSymbol().IsBuiltin() && GetSymbol().IsFunction();
+    }
+
+    /// Do both nodes refer to the same (non-linked) variable?
+    bool RefersTo(const ASTNode_Var & other) const {
+      if (var.IsLinked() || other.var.IsLinked()) return false;
+      return &GetSymbol() == &other.GetSymbol();
+    }
+
+    /// Does this variable refer to a built-in function without side effects?
+    bool IsPureFunction() const { return IsBuiltinFunction() && GetSymbol().IsPure(); }
+
+    bool AppendKey(std::string & key) const override {
+      (key += 'V') += std::to_string(var.GetID());
+      return true;
+    }
+
     std::optional<LValue> AsLValue() override {
       return LValue(var);
     }
 
-    symbol_ptr_t Process() override { 
+    Value Process() override { 
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -261,6 +369,46 @@ namespace emplode {
     }
   };
 
+  /// An ASTNode that reads an argument of the signal currently being triggered directly,
+  /// without it first being copied into a parameter variable.
+  class ASTNode_TriggerArg : public ASTNode {
+  protected:
+    const emp::Ptr<const symbol_vector_t> & args;  ///< Arguments of the current trigger.
+    size_t arg_id;
+    std::string name;                              ///< Name of the parameter being read.
+
+  public:
+    ASTNode_TriggerArg(const emp::Ptr<const symbol_vector_t> & _args, size_t _id,
+                       const std::string & _name, int _line=-1)
+      : args(_args), arg_id(_id), name(_name)
+    {
+      line_id = _line;
+    }
+
+    const std::string & GetName() const override { return name; }
+    bool HasValue() const override { return true; }
+    bool IsLeaf() const override { return true; }
+
+    bool AppendKey(std::string & key) const override {
+      (key += 'T') += std::to_string(reinterpret_cast<uintptr_t>(&args));
+      (key += ':') += std::to_string(arg_id);
+      return true;
+    }
+
+    /// The caller of the trigger owns its arguments, so they are only ever borrowed.
+    Value Process() override {
+      emp_assert(args && arg_id < args->size(), "Trigger argument used outside of a trigger.", name);
+      return Value::Borrow((*args)[arg_id]);
+    }
+
+    void Write(std::ostream & os, const std::string &) const override { os << name; }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_TriggerArg : " << name << " (arg " << arg_id << ")" << std::endl;
+    }
+  };
+
   /// An ASTNode representing a literal symbol like a number or break/continue
   class ASTNode_Leaf : public ASTNode {
   protected:
@@ -287,7 +435,17 @@ namespace emplode {
 
     bool IsLeaf() const override { return true; }
 
-    symbol_ptr_t Process() override { 
+    bool AppendKey(std::string & key) const override {
+      if (symbol_ptr->IsNumeric()) {
+        (key += 'N') += std::to_string(std::bit_cast<uint64_t>(symbol_ptr->AsDouble()));
+      } else if (symbol_ptr->IsString()) {
+        const std::string & value = symbol_ptr->AsString();
+        ((key += 'S') += std::to_string(value.size()) += ':') += value;
+      } else return false;
+      return true;
+    }
+
+    Value Process() override { 
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -315,13 +473,13 @@ namespace emplode {
 
   // Helper functions for making temporary leaves.
   emp::Ptr<ASTNode_Leaf> MakeTempLeaf(double val, int line_id=-1) {
-    auto symbol_ptr = emp::NewPtr<Symbol_Var>("__Temp", val, "Temporary double", nullptr);
+    auto symbol_ptr = emp::NewPtr<Symbol_Var>("", val, "", nullptr);
     symbol_ptr->SetTemporary();
     return emp::NewPtr<ASTNode_Leaf>(symbol_ptr, line_id);
   }
 
   emp::Ptr<ASTNode_Leaf> MakeTempLeaf(const std::string & val, int line_id=-1) {
-    auto symbol_ptr = emp::NewPtr<Symbol_Var>("__Temp", val, "Temporary string", nullptr);
+    auto symbol_ptr = emp::NewPtr<Symbol_Var>("", val, "", nullptr);
     symbol_ptr->SetTemporary();
     return emp::NewPtr<ASTNode_Leaf>(symbol_ptr, line_id);
   }
@@ -356,7 +514,7 @@ namespace emplode {
     }
     void SetSymbolTable(SymbolTableBase & _st) { symbol_table = &_st; }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -365,10 +523,8 @@ namespace emplode {
       #endif
 
       for (auto node : children) {
-        symbol_ptr_t out = node->Process();                  // Process this line.
-        if (!out) continue;                                  // No return symbol?  Keep going!
-        if (out->IsInterrupt()) return out;                  // Propagate a break or continue
-        if (out->IsTemporary()) out.Delete();                // Clean up anything else, if needed
+        Value out = node->Process();                         // Process this line.
+        if (out && out->IsInterrupt()) return out;           // Propagate a break or continue
       }
       return nullptr;
     }
@@ -393,7 +549,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override;
+    Value Process() override;
 
     void Write(std::ostream & os, const std::string & offset) const override { 
       os << "COPY_FIELDS ";
@@ -419,7 +575,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override;
+    Value Process() override;
 
     void Write(std::ostream & os, const std::string & offset) const override { 
       os << "CLASS_INIT " << name;
@@ -440,7 +596,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override;
+    Value Process() override;
 
     void Write(std::ostream & os, const std::string & offset) const override { 
       os << "STRUCT_INIT " << name;
@@ -458,7 +614,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -466,8 +622,8 @@ namespace emplode {
       );
       #endif
       emp_assert(children.size() == 1);
-      symbol_ptr_t result = children[0]->Process();
-      result = result->Clone();
+      Value original = children[0]->Process();
+      symbol_ptr_t result = original->Clone();
       result->SetTemporary();
       return result;
     }
@@ -490,7 +646,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override;
+    Value Process() override;
 
     void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
       for (size_t i = 0; i < indent; ++i) os << " ";
@@ -505,17 +661,20 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
         "AST: Processing return"
       );
       #endif
-      symbol_ptr_t result = nullptr;
+      Value result = nullptr;
       if (children.size() > 0)
         result = children[0]->Process();
-      return emp::NewPtr<Symbol_Special>(Symbol_Special::RETURN, result);
+      // The special symbol takes over the result (if owned) and is itself temporary.
+      auto out = emp::NewPtr<Symbol_Special>(Symbol_Special::RETURN, result.Release());
+      out->SetTemporary();
+      return out;
     }
 
     void Write(std::ostream & os, const std::string & offset) const override { 
@@ -545,7 +704,9 @@ namespace emplode {
 
     void SetFun(std::function< double(double) > _fun) { fun = _fun; }
 
-    symbol_ptr_t Process() override {
+    bool AppendKey(std::string & key) const override { (key += '1') += name; return true; }
+
+    Value Process() override {
       emp_assert(children.size() == 1);
       #ifndef NDEBUG
       emp::notify::Verbose(
@@ -572,7 +733,9 @@ namespace emplode {
   /// Binary operations.
   class ASTNode_Op2 : public ASTNode_Internal {
   protected:
+    using list_fun_t = std::function< symbol_ptr_t(symbol_ptr_t, symbol_ptr_t) >;
     std::function< emp::Datum(emp::Datum, emp::Datum) > fun;
+    list_fun_t list_fun;     ///< Optional elementwise version, used if either input is a list.
   public:
     ASTNode_Op2(const std::string & name, int _line=-1) : ASTNode_Internal(name) {
       line_id = _line;
@@ -584,8 +747,11 @@ namespace emplode {
     bool HasValue() const override { return true; }
 
     void SetFun(std::function< emp::Datum(emp::Datum, emp::Datum) > _fun) { fun = _fun; }
+    void SetListFun(list_fun_t _fun) { list_fun = _fun; }
+
+    bool AppendKey(std::string & key) const override { (key += '2') += name; return true; }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       emp_assert(children.size() == 2);
       #ifndef NDEBUG
       emp::notify::Verbose(
@@ -593,8 +759,14 @@ namespace emplode {
         "AST: Processing binary op: ", name
       );
       #endif
-      auto out_val = fun(children[0]->template ProcessAs<emp::Datum>(),
-                         children[1]->template ProcessAs<emp::Datum>());
+      Value in1 = children[0]->Process();
+      Value in2 = children[1]->Process();
+
+      if (list_fun && ((in1 && in1->IsList()) || (in2 && in2->IsList()))) {
+        return list_fun(in1.Get(), in2.Get());
+      }
+      auto out_val = fun(in1 ? in1->As<emp::Datum>() : emp::Datum(),
+                         in2 ? in2->As<emp::Datum>() : emp::Datum());
       return GetSymbolTable().MakeTempSymbol(out_val);
     }
 
@@ -632,10 +804,12 @@ namespace emplode {
     bool HasNumericReturn() const override { return children[1]->HasNumericReturn(); }
     bool HasStringReturn() const override { return children[1]->HasStringReturn(); }
 
-    symbol_ptr_t Process() override {
+    bool IsLValueChild(size_t id) const override { return id == 0; }
+
+    Value Process() override {
       emp_assert(children.size() == 2);
       std::optional<LValue> lhs = children[0]->AsLValue();  // Determine the left-hand-side value.
-      symbol_ptr_t rhs = children[1]->Process();  // Determine the right-hand-side value.
+      Value rhs = children[1]->Process();         // Determine the right-hand-side value.
 
       if (!lhs.has_value()) {
         std::cerr << "lhs of assignment is not an lvalue:" << std::endl;
@@ -643,12 +817,10 @@ namespace emplode {
         exit(1);
       }
 
-      // lhs needs to own its value, so we clone it to make sure that's possible
-      if (!rhs->IsTemporary())
-        rhs = rhs->ShallowClone();
-      lhs->SetValue(rhs);
+      // lhs needs to own its value, so a borrowed rhs is cloned.
+      lhs->SetValue(rhs.Detach());
 
-      return lhs->GetValue();
+      return lhs->TakeValue();
     }
 
     void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
@@ -667,7 +839,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -676,13 +848,12 @@ namespace emplode {
       #endif
 
       double test = children[0]->ProcessAs<double>();             // Determine state of condition
-      symbol_ptr_t out = nullptr;                                 // Prepare for output symbol.
+      Value out = nullptr;                                        // Prepare for output symbol.
 
       if (test != 0.0) out = children[1]->Process();              // Process if TRUE
       else if (children.size() > 2) out = children[2]->Process(); // Process if FALSE
 
-      if (out && (out->IsInterrupt())) return out; // Propagate break/continue
-      if (out && out->IsTemporary()) out.Delete();                  // Clean up out, if needed
+      if (out && out->IsInterrupt()) return out;                  // Propagate break/continue
       return nullptr;
     }
 
@@ -712,7 +883,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       #ifndef NDEBUG
       emp::notify::Verbose(
         "Emplode::AST",
@@ -720,13 +891,14 @@ namespace emplode {
       );
       #endif
 
+      SymbolTableBase & symbol_table = GetSymbolTable();
       while (children[0]->ProcessAs<double>()) {
-        symbol_ptr_t out = children[1]->Process();
+        if (!symbol_table.UseStep()) [[unlikely]] symbol_table.BudgetExceeded(line_id, "WHILE loop");
+        Value out = children[1]->Process();
         if (out) {
           if (out->IsBreak())     { break; }
           if (out->IsContinue())  { continue; }
           if (out->IsReturn())    { return out; }
-          if (out->IsTemporary()) { out.Delete(); }
         }
       }
 
@@ -747,6 +919,238 @@ namespace emplode {
     }
   };
 
+  /// FOR (init; test; step) body, or FOR (i IN start..end) body (counting from start up to, but
+  /// not including, end).
+  ///
+  /// A counting loop, where init assigns to a variable, test compares that variable to a bound
+  /// (<, <=, >, >=, !=), and step adds to or subtracts from it, may keep its count in a double
+  /// rather than building temporaries for the test and step on each iteration; this must be
+  /// turned on with SetCounting() once the loop is known to qualify (see Optimizer.hpp).  When
+  /// the body may look at the variable, the count is written to it before each test and read
+  /// back after each run of the body; otherwise the variable is only updated when the loop ends.
+  /// Range loops always count.
+  class ASTNode_For : public ASTNode_Internal {
+  public:
+    enum class Compare { LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, NOT_EQUAL };
+
+  private:
+    emp::Ptr<Symbol_Scope> scope;            ///< Owned scope for variables declared in the loop.
+    emp::Ptr<ASTNode_Var> counter = nullptr; ///< Variable being counted (null if none).
+    bool is_range = false;                   ///< Children: counter, start, end, body
+                                             ///<   (otherwise: init, test, step, body).
+    bool counting = false;                   ///< Use the counting fast path?
+    bool observed = true;                    ///< Might the variable be used during the loop?
+    Compare compare = Compare::LESS;
+    bool count_down = false;                 ///< Is the step a subtraction?
+
+    static bool IsNumber(const Symbol & symbol) { return symbol.IsLocal() && symbol.IsNumeric(); }
+
+    bool Test(double value, double limit) const {
+      switch (compare) {
+        case Compare::LESS:          return value < limit;
+        case Compare::LESS_EQUAL:    return value <= limit;
+        case Compare::GREATER:       return value > limit;
+        case Compare::GREATER_EQUAL: return value >= limit;
+        case Compare::NOT_EQUAL:     return value != limit;
+      }
+      return false;
+    }
+
+    /// Write the count to the variable (in place, if it already holds a plain value).
+    void Store(double value) {
+      Var var = counter->GetVar();
+      emp::Ptr<Symbol> symbol = var.GetValue();
+      if (symbol->IsLocal() && (symbol->IsNumeric() || symbol->IsString())) symbol->SetValue(value);
+      else var.SetValue(GetSymbolTable().MakeTempSymbol(value));
+    }
+
+    /// Does a loop control value tell the enclosing loop to stop?
+    static bool IsExit(const Value & out) { return out && (out->IsBreak() || out->IsReturn()); }
+
+    /// Run a counting loop from after init; sets done=false if the loop must be finished by
+    /// ProcessGeneric() (when the variable or a bound stops being a number).
+    Value ProcessCounting(bool & done) {
+      SymbolTableBase & symbol_table = GetSymbolTable();
+      done = false;
+      emp::Ptr<Symbol> symbol = &counter->GetSymbol();
+      if (!IsNumber(*symbol)) return nullptr;
+      node_ptr_t limit_node = children[1]->GetChild(1);
+      node_ptr_t amount_node = children[2]->GetChild(1)->GetChild(1);
+      double value = symbol->AsDouble();
+      while (true) {
+        if (observed) Store(value);
+        Value limit = limit_node->Process();
+        if (!limit || !limit->IsNumeric()) { Store(value); return nullptr; }
+        if (!Test(value, limit->AsDouble())) break;
+        if (!symbol_table.UseStep()) [[unlikely]] symbol_table.BudgetExceeded(line_id, "FOR loop");
+        Value out = children[3]->Process();
+        if (IsExit(out)) {
+          if (!observed) Store(value);
+          done = true;
+          return out->IsReturn() ? std::move(out) : nullptr;
+        }
+        if (observed) {
+          symbol = &counter->GetSymbol();
+          if (!IsNumber(*symbol)) { children[2]->Process(); return nullptr; }
+          value = symbol->AsDouble();
+        }
+        Value amount = amount_node->Process();
+        if (!amount || !amount->IsNumeric()) { Store(value); children[2]->Process(); return nullptr; }
+        if (count_down) value -= amount->AsDouble();
+        else value += amount->AsDouble();
+      }
+      if (!observed) Store(value);
+      done = true;
+      return nullptr;
+    }
+
+    /// Run a C-style loop from its first test.
+    Value ProcessGeneric() {
+      SymbolTableBase & symbol_table = GetSymbolTable();
+      while (children[1]->ProcessAs<double>()) {
+        if (!symbol_table.UseStep()) [[unlikely]] symbol_table.BudgetExceeded(line_id, "FOR loop");
+        Value out = children[3]->Process();
+        if (IsExit(out)) return out->IsReturn() ? std::move(out) : nullptr;
+        children[2]->Process();      // A CONTINUE still runs the step.
+      }
+      return nullptr;
+    }
+
+    Value ProcessRange() {
+      SymbolTableBase & symbol_table = GetSymbolTable();
+      double value = children[1]->ProcessAs<double>();
+      const double limit = children[2]->ProcessAs<double>();
+      while (true) {
+        if (observed) Store(value);
+        if (!(value < limit)) break;
+        if (!symbol_table.UseStep()) [[unlikely]] symbol_table.BudgetExceeded(line_id, "FOR loop");
+        Value out = children[3]->Process();
+        if (IsExit(out)) {
+          if (!observed) Store(value);
+          return out->IsReturn() ? std::move(out) : nullptr;
+        }
+        if (observed) value = counter->GetSymbol().AsDouble();
+        value += 1.0;
+      }
+      if (!observed) Store(value);
+      return nullptr;
+    }
+
+  public:
+    /// C-style loop.
+    ASTNode_For(emp::Ptr<Symbol_Scope> scope, node_ptr_t init, node_ptr_t test, node_ptr_t step,
+                node_ptr_t body, int _line=-1) : scope(scope) {
+      AddChild(init);
+      AddChild(test);
+      AddChild(step);
+      AddChild(body);
+      line_id = _line;
+      FindCounter();
+    }
+
+    /// Range loop.
+    ASTNode_For(emp::Ptr<Symbol_Scope> scope, emp::Ptr<ASTNode_Var> var, node_ptr_t start,
+                node_ptr_t end, node_ptr_t body, int _line=-1)
+      : scope(scope), counter(var), is_range(true), counting(true)
+    {
+      AddChild(var);
+      AddChild(start);
+      AddChild(end);
+      AddChild(body);
+      line_id = _line;
+    }
+
+    ~ASTNode_For();   // Defined in Symbol_Scope.hpp
+
+    emp::Ptr<Symbol_Scope> GetScope() override { return scope; }
+
+    bool IsRange() const { return is_range; }
+    bool IsCounting() const { return counting; }
+    bool IsObserved() const { return observed; }
+
+    /// Induction variable, if this is a counting loop (whether or not counting is turned on).
+    emp::Ptr<ASTNode_Var> GetCounter() const { return counter; }
+
+    /// Expressions evaluated on every iteration of a counting loop.
+    node_ptr_t GetLimit() const { return is_range ? nullptr : children[1]->GetChild(1); }
+    node_ptr_t GetStepAmount() const { return is_range ? nullptr : children[2]->GetChild(1)->GetChild(1); }
+    node_ptr_t GetBody() const { return children[3]; }
+
+    /// Turn on counting for a C-style loop that qualifies (the range form always counts).
+    void SetCounting(bool in_observed) {
+      emp_assert(counter);
+      counting = true;
+      observed = in_observed;
+    }
+
+    bool IsLValueChild(size_t id) const override { return is_range && id == 0; }
+
+    Value Process() override {
+      #ifndef NDEBUG
+      emp::notify::Verbose(
+        "Emplode::AST",
+        "AST: Processing FOR"
+      );
+      #endif
+
+      if (is_range) return ProcessRange();
+      children[0]->Process();
+      if (counting) {
+        bool done = false;
+        Value out = ProcessCounting(done);
+        if (done) return out;
+      }
+      return ProcessGeneric();
+    }
+
+    void Write(std::ostream & os, const std::string & offset) const override {
+      os << "FOR (";
+      children[0]->Write(os, offset);
+      os << (is_range ? " IN " : "; ");
+      children[1]->Write(os, offset);
+      os << (is_range ? ".." : "; ");
+      children[2]->Write(os, offset);
+      os << ") ";
+      children[3]->Write(os, offset);
+    }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_For: " << (is_range ? "range" : "steps") << std::endl;
+      for (auto child : children) child->PrintAST(os, indent+2);
+    }
+
+  private:
+    /// Identify the variable of a loop shaped like FOR (i = a; i < b; i = i + s).
+    void FindCounter() {
+      auto init = children[0].DynamicCast<ASTNode_Assign>();
+      auto test = children[1].DynamicCast<ASTNode_Op2>();
+      auto step = children[2].DynamicCast<ASTNode_Assign>();
+      if (!init || !test || !step) return;
+      auto var = init->GetChild(0).DynamicCast<ASTNode_Var>();
+      if (!var || var->GetVar().IsLinked()) return;
+      auto SameVar = [var](node_ptr_t node) {
+        auto other = node.DynamicCast<ASTNode_Var>();
+        return other && other->GetVar().GetID() == var->GetVar().GetID();
+      };
+
+      const std::string & op = test->GetName();
+      if (op == "<") compare = Compare::LESS;
+      else if (op == "<=") compare = Compare::LESS_EQUAL;
+      else if (op == ">") compare = Compare::GREATER;
+      else if (op == ">=") compare = Compare::GREATER_EQUAL;
+      else if (op == "!=") compare = Compare::NOT_EQUAL;
+      else return;
+      if (!SameVar(test->GetChild(0))) return;
+
+      auto update = step->GetChild(1).DynamicCast<ASTNode_Op2>();
+      if (!SameVar(step->GetChild(0)) || !update || !SameVar(update->GetChild(0))) return;
+      if (update->GetName() != "+" && update->GetName() != "-") return;
+      count_down = update->GetName() == "-";
+      counter = var;
+    }
+  };
+
   class ASTNode_Call : public ASTNode_Internal {
   public:
     ASTNode_Call(node_ptr_t fun, const node_vector_t & args, int _line=-1) {
@@ -754,6 +1158,11 @@ namespace emplode {
       for (auto arg : args) AddChild(arg);
       line_id = _line;
     }
+    /// Build from the children of another call: the function followed by its arguments.
+    ASTNode_Call(const node_vector_t & fun_and_args, int _line) {
+      for (auto child : fun_and_args) AddChild(child);
+      line_id = _line;
+    }
 
     bool IsNumeric() const override { return children[0]->HasNumericReturn(); }
     bool IsString() const override { return children[0]->HasStringReturn(); }
@@ -761,7 +1170,16 @@ namespace emplode {
     // @CAO Technically, one function can return another, so we should check
     // HasNumericReturn() and HasStringReturn() on return values... but hard to implement.
 
-    symbol_ptr_t Process() override {
+    /// Calls are pure only for built-in functions marked pure.
+    bool AppendKey(std::string & key) const override {
+      auto fun = children[0].DynamicCast<ASTNode_Var>();
+      if (!fun || !fun->IsPureFunction()) return false;
+      key += "()";
+      return true;
+    }
+    bool RunsAfterChildren() const override { return true; }
+
+    Value Process() override {
       emp_assert(children.size() >= 1);
       #ifndef NDEBUG
       emp::notify::Verbose(
@@ -771,12 +1189,18 @@ namespace emplode {
       #endif
 
 
-      symbol_ptr_t fun = children[0]->Process();
+      Value fun = children[0]->Process();
 
-      // Collect all arguments and call
+      // Collect all arguments and call; the values own any temporaries until the call is done.
+      emp::vector<Value> arg_values;
       symbol_vector_t args;
+      arg_values.reserve(children.size() - 1);
+      args.reserve(children.size() - 1);
       for (size_t i = 1; i < children.size(); i++) {
-        args.push_back(children[i]->Process());
+        arg_values.push_back(children[i]->Process());
+        // Functions may take over temporary arguments, so pass them a copy of a borrowed one.
+        if (arg_values.back().IsBorrowed()) arg_values.back() = Value(arg_values.back().Release());
+        args.push_back(arg_values.back().Get());
       }
 
       emp::notify::Verbose(
@@ -784,15 +1208,12 @@ namespace emplode {
         "AST: Calling function '", fun->GetName(), " with ", args.size(), " arguments."
       );
 
-      symbol_ptr_t result = fun->Call(args);
+      Value result = fun->Call(args);
       if (result && result->IsError()) {
         std::cerr << "Call error: ";
         result->Write(std::cerr);
         exit(1);
       }
-
-      // Cleanup and return
-      for (auto arg : args) if (arg->IsTemporary()) arg.Delete();
       return result;
     }
 
@@ -833,7 +1254,7 @@ namespace emplode {
       line_id = _line;
     }
 
-    symbol_ptr_t Process() override {
+    Value Process() override {
       emp_assert(children.size() >= 1);
 
       #ifndef NDEBUG
@@ -843,9 +1264,12 @@ namespace emplode {
       );
       #endif
 
+      emp::vector<Value> arg_values;
       symbol_vector_t arg_entries;
+      arg_values.reserve(children.size());
       for (size_t id = 1; id < children.size(); id++) {
-        arg_entries.push_back( children[id]->Process() );
+        arg_values.push_back( children[id]->Process() );
+        arg_entries.push_back( arg_values.back().Get() );
       }
       setup_event(children[0], arg_entries);
       return nullptr;
@@ -868,6 +1292,58 @@ namespace emplode {
     }
   };
 
+  class ASTNode_Trigger : public ASTNode_Internal {
+  protected:
+    using trigger_fun_t = std::function<void(const symbol_vector_t &)>;
+    trigger_fun_t trigger_fun;
+
+  public:
+    ASTNode_Trigger(const std::string & signal_name, const node_vector_t & args,
+                    trigger_fun_t in_fun, int _line=-1)
+     : ASTNode_Internal(signal_name), trigger_fun(in_fun)
+    {
+      for (auto arg : args) AddChild(arg);
+      line_id = _line;
+    }
+
+    bool RunsAfterChildren() const override { return true; }
+
+    Value Process() override {
+      #ifndef NDEBUG
+      emp::notify::Verbose(
+        "Emplode::AST",
+        "AST: Processing Trigger"
+      );
+      #endif
+
+      emp::vector<Value> arg_values;
+      symbol_vector_t args;
+      arg_values.reserve(children.size());
+      args.reserve(children.size());
+      for (auto child : children) {
+        arg_values.push_back( child->Process() );
+        args.push_back( arg_values.back().Get() );
+      }
+      trigger_fun(args);
+      return nullptr;
+    }
+
+    void Write(std::ostream & os, const std::string & offset) const override {
+      os << "TRIGGER " << GetName() << "(";
+      for (size_t i = 0; i < children.size(); i++) {
+        if (i>0) os << ", ";
+        children[i]->Write(os, offset);
+      }
+      os << ")";
+    }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_Trigger: " << GetName() << std::endl;
+      for (auto child : children) child->PrintAST(os, indent+2);
+    }
+  };
+
   class ASTNode_Member : public ASTNode_Internal {
   private:
     std::string name;
@@ -877,10 +1353,12 @@ namespace emplode {
       : name(name), ASTNode_Internal(name) {}
 
     std::optional<LValue> AsLValue() override;
-    symbol_ptr_t Process() override {
-      return AsLValue()->GetValue();
+    Value Process() override {
+      return AsLValue()->TakeValue();
     }
 
+    bool AppendKey(std::string & key) const override { (key += '.') += name; return true; }
+
     void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
       emp_assert(children.size() == 1);
 
@@ -895,10 +1373,12 @@ namespace emplode {
     ASTNode_Subscript() : ASTNode_Internal() {}
 
     std::optional<LValue> AsLValue() override;
-    symbol_ptr_t Process() override {
-      return AsLValue()->GetValue();
+    Value Process() override {
+      return AsLValue()->TakeValue();
     }
 
+    bool AppendKey(std::string & key) const override { key += "[]"; return true; }
+
     void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
       emp_assert(children.size() == 2);
 
@@ -0,0 +1,220 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  BuiltinLibrary.hpp
+ *  @brief A process-wide library of built-in functions shared by all Emplode instances.
+ *  @note Status: BETA
+ *
+ *  Built-in functions that do not depend on a particular Emplode instance (such as the math
+ *  functions) are wrapped only once, the first time any symbol table is created.  Every root
+ *  scope uses the library scope as its parent, so lookups fall through to the library when a
+ *  name is not defined locally; functions added to an instance shadow library versions.
+ *
+ *  All of the library functions broadcast over numeric lists (see ListMath.hpp); the most
+ *  common ones are given vectorized kernels.  Statistics functions (MEAN, MEDIAN, etc.) take
+ *  whole lists.
+ *
+ *  The library is not changed after construction, and its variables keep atomic reference
+ *  counts (see Var::SetShared()), so it can be used by instances on different threads.
+ */
+
+#ifndef EMPLODE_BUILTIN_LIBRARY_HPP
+#define EMPLODE_BUILTIN_LIBRARY_HPP
+
+#include <cmath>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#include "emp/base/assert.hpp"
+#include "emp/math/constants.hpp"
+#include "emp/math/math.hpp"
+
+#include "ListMath.hpp"
+#include "Stats.hpp"
+#include "Symbol_Scope.hpp"
+#include "SymbolTableBase.hpp"
+
+namespace emplode {
+
+  class BuiltinLibrary : public SymbolTableBase {
+  private:
+    Symbol_Scope scope;   ///< Scope holding all of the shared built-in functions.
+
+    /// Add a math function; list arguments are broadcast through the provided kernel.
+    template <typename FUN_T>
+    void AddFunction(const std::string & name, FUN_T fun, const std::string & desc,
+                     ListMath::kernel_t kernel) {
+      using info_t = emp::FunInfo<FUN_T>;
+      auto emplode_fun = ListMath::MakeBroadcasting(name, info_t::num_args,
+                                                    WrapFunction(name, fun), kernel);
+      using return_t = typename info_t::return_t;
+      scope.AddBuiltinFunction(name, emplode_fun, desc, emp::GetTypeID<return_t>())
+        .GetValue()->AsFunctionPtr()->SetPure();
+    }
+
+    /// Add a math function that broadcasts over lists with a plain loop.
+    template <typename FUN_T>
+    void AddFunction(const std::string & name, FUN_T fun, const std::string & desc) {
+      AddFunction(name, fun, desc, ListMath::MakeKernel(fun));
+    }
+
+    /// Add a function that works on whole lists at once (so it is not broadcast).
+    template <typename FUN_T>
+    void AddListFunction(const std::string & name, FUN_T fun, const std::string & desc) {
+      auto emplode_fun = WrapFunction(name, fun);
+      using return_t = typename emp::FunInfo<FUN_T>::return_t;
+      scope.AddBuiltinFunction(name, emplode_fun, desc, emp::GetTypeID<return_t>())
+        .GetValue()->AsFunctionPtr()->SetPure();
+    }
+
+    /// Statistics over numeric lists; see Stats.hpp for the algorithms.
+    void SetupStatsFunctions() {
+      using args_t = const emp::vector<emp::Ptr<Symbol>> &;
+
+      AddListFunction("MEAN", [](args_t args){
+        RequireArgs(args, {1}, "MEAN");
+        return Stats::Mean(ListMath::GatherValues("MEAN", args[0]));
+      }, "Mean of the values in a list" );
+      AddListFunction("VARIANCE", [](args_t args){
+        RequireArgs(args, {1}, "VARIANCE");
+        return Stats::Variance(ListMath::GatherValues("VARIANCE", args[0]));
+      }, "Population variance of the values in a list" );
+      AddListFunction("STDDEV", [](args_t args){
+        RequireArgs(args, {1}, "STDDEV");
+        return Stats::StdDev(ListMath::GatherValues("STDDEV", args[0]));
+      }, "Population standard deviation of the values in a list" );
+      AddListFunction("MEDIAN", [](args_t args){
+        RequireArgs(args, {1}, "MEDIAN");
+        auto values = ListMath::GatherValues("MEDIAN", args[0]);
+        return Stats::Median(values);
+      }, "Median of the values in a list" );
+      AddListFunction("QUANTILE", [](args_t args){
+        RequireArgs(args, {2}, "QUANTILE");
+        auto values = ListMath::GatherValues("QUANTILE", args[0]);
+        return Stats::Quantile(values, args[1]->AsDouble());
+      }, "Value at fraction arg2 (0 to 1) through the sorted list arg1" );
+      AddListFunction("HISTOGRAM", [](args_t args){
+        RequireArgs(args, {2, 4}, "HISTOGRAM");
+        const auto values = ListMath::GatherValues("HISTOGRAM", args[0]);
+        const double num_bins = args[1]->AsDouble();
+        if (!(num_bins >= 1.0)) {
+          std::cerr << "Error: HISTOGRAM requires at least one bin; received " << num_bins << "." << std::endl;
+          exit(1);
+        }
+        if (args.size() == 2) return ListMath::MakeList(Stats::Histogram(values, static_cast<size_t>(num_bins)));
+        return ListMath::MakeList(
+          Stats::Histogram(values, static_cast<size_t>(num_bins), args[2]->AsDouble(), args[3]->AsDouble())
+        );
+      }, "Counts of list arg1 in arg2 equal-width bins (over the full range, or [arg3,arg4])" );
+      AddListFunction("ENTROPY", [](args_t args){
+        RequireArgs(args, {1}, "ENTROPY");
+        auto values = ListMath::GatherValues("ENTROPY", args[0]);
+        return Stats::Entropy(values);
+      }, "Shannon entropy (in bits) of the distinct values in a list" );
+      AddListFunction("CORRELATION", [](args_t args){
+        RequireArgs(args, {2}, "CORRELATION");
+        const auto x = ListMath::GatherValues("CORRELATION", args[0]);
+        const auto y = ListMath::GatherValues("CORRELATION", args[1]);
+        if (x.size() != y.size()) {
+          std::cerr << "Error: CORRELATION lists have different lengths (" << x.size()
+                    << " vs. " << y.size() << ")." << std::endl;
+          exit(1);
+        }
+        return Stats::Correlation(x, y);
+      }, "Pearson correlation between two equal-length lists" );
+    }
+
+    BuiltinLibrary() : scope("Builtins", "Built-in functions shared by all instances", nullptr, this) {
+      // Default 1-input math functions
+      AddFunction("ABS", [](double x){ return std::abs(x); }, "Absolute Value",
+                  ListMath::Kernel<ListMath::OpAbs> );
+      AddFunction("EXP", [](double x){ return emp::Pow(emp::E, x); }, "Exponentiation" );
+      AddFunction("LOG2", [](double x){ return std::log(x); }, "Log base-2" );
+      AddFunction("LOG10", [](double x){ return std::log10(x); }, "Log base-10" );
+
+      AddFunction("SQRT", [](double x){ return std::sqrt(x); }, "Square Root",
+                  ListMath::Kernel<ListMath::OpSqrt> );
+      AddFunction("CBRT", [](double x){ return std::cbrt(x); }, "Cube Root" );
+
+      AddFunction("SIN", [](double x){ return std::sin(x); }, "Sine" );
+      AddFunction("COS", [](double x){ return std::cos(x); }, "Cosine" );
+      AddFunction("TAN", [](double x){ return std::tan(x); }, "Tangent" );
+      AddFunction("ASIN", [](double x){ return std::asin(x); }, "Arc Sine" );
+      AddFunction("ACOS", [](double x){ return std::acos(x); }, "Arc Cosine" );
+      AddFunction("ATAN", [](double x){ return std::atan(x); }, "Arc Tangent" );
+      AddFunction("SINH", [](double x){ return std::sinh(x); }, "Hyperbolic Sine" );
+      AddFunction("COSH", [](double x){ return std::cosh(x); }, "Hyperbolic Cosine" );
+      AddFunction("TANH", [](double x){ return std::tanh(x); }, "Hyperbolic Tangent" );
+      AddFunction("ASINH", [](double x){ return std::asinh(x); }, "Hyperbolic Arc Sine" );
+      AddFunction("ACOSH", [](double x){ return std::acosh(x); }, "Hyperbolic Arc Cosine" );
+      AddFunction("ATANH", [](double x){ return std::atanh(x); }, "Hyperbolic Arc Tangent" );
+
+      AddFunction("CEIL", [](double x){ return std::ceil(x); }, "Round UP" );
+      AddFunction("FLOOR", [](double x){ return std::floor(x); }, "Round DOWN" );
+      AddFunction("ROUND", [](double x){ return std::round(x); }, "Round to nearest" );
+
+      AddFunction("ISINF", [](double x){ return std::isinf(x); }, "Test if Infinite" );
+      AddFunction("ISNAN", [](double x){ return std::isnan(x); }, "Test if Not-a-number" );
+
+      // Default 2-input math functions
+      AddFunction("HYPOT", [](double x, double y){ return std::hypot(x,y); }, "Given sides, find hypotenuse" );
+      AddFunction("LOG", [](double x, double y){ return emp::Pow(x,y); }, "Take log of arg1 with base arg2" );
+      AddFunction("MIN", [](double x, double y){ return (x<y) ? x : y; }, "Return lesser value",
+                  ListMath::Kernel<ListMath::OpMin> );
+      AddFunction("MAX", [](double x, double y){ return (x>y) ? x : y; }, "Return greater value",
+                  ListMath::Kernel<ListMath::OpMax> );
+      AddFunction("POW", [](double x, double y){ return emp::Pow(x,y); }, "Take arg1 to the arg2 power" );
+
+      // Default 3-input math functions
+      AddFunction("IF", [](double x, double y, double z){ return (x!=0.0) ? y : z; },
+                  "If arg1 is true, return arg2, else arg3" );
+      AddFunction("CLAMP", [](double x, double y, double z){ return (x<y) ? y : (x>z) ? z : x; },
+                  "Return arg1, forced into range [arg2,arg3]", ListMath::Kernel<ListMath::OpClamp> );
+      AddFunction("TO_SCALE", [](double x, double y, double z){ return (z-y)*x+y; },
+                  "Scale arg1 to arg2-arg3 as unit distance" );
+      AddFunction("FROM_SCALE", [](double x, double y, double z){ return (x-y) / (z-y); },
+                  "Scale arg1 from arg2-arg3 as unit distance" );
+
+      SetupStatsFunctions();
+
+      // Every instance copies these variables when looking them up, possibly from different
+      // threads, so their reference counts must be atomic.
+      scope.SetShared();
+    }
+
+  public:
+    BuiltinLibrary(const BuiltinLibrary &) = delete;
+    BuiltinLibrary & operator=(const BuiltinLibrary &) = delete;
+
+    /// Make sure a function received one of the allowed numbers of arguments.
+    static void RequireArgs(const emp::vector<emp::Ptr<Symbol>> & args,
+                            std::initializer_list<size_t> allowed, const std::string & fun_name) {
+      for (size_t count : allowed) if (args.size() == count) return;
+      std::cerr << "Error in call to function '" << fun_name << "'; expected";
+      for (size_t count : allowed) std::cerr << " " << count;
+      std::cerr << " arguments, but received " << args.size() << "." << std::endl;
+      exit(1);
+    }
+
+    /// Library functions only ever produce numbers, strings, and lists.
+    emp::Ptr<Symbol_Object> MakeTempObjSymbol(emp::TypeID, emp::Ptr<EmplodeType>) override {
+      emp_assert(false, "Built-in library functions cannot create objects.");
+      return nullptr;
+    }
+
+    /// Access the shared library, building it on first use.
+    static BuiltinLibrary & Get() {
+      static BuiltinLibrary library;
+      return library;
+    }
+
+    Symbol_Scope & GetScope() { return scope; }
+    const Symbol_Scope & GetScope() const { return scope; }
+  };
+
+}
+
+#endif
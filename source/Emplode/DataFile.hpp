@@ -1,76 +1,300 @@
 /**
  *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
  *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
- *  @date 2021.
+ *  @date 2021-2022.
  *
  *  @file  DataFile.hpp
  *  @brief Manages a DataFile object for config.
  *  @note Status: BETA
+ *
+ *  Columns may be marked "pure" when their functions have no side effects and are safe to
+ *  call from another thread (for example, a C++ reduction over a population that is not
+ *  being modified).  If a DataFile is given more than one thread, its pure columns are
+ *  evaluated concurrently each time a line is written; all other columns still run in order
+ *  on the calling thread, and setup commands always run first.  Columns that execute script
+ *  code (ADD_COLUMN) are never pure, since the interpreter is not thread-safe.  Script columns
+ *  added back to back are compiled together, so a subexpression they share (say, a mean used
+ *  by several columns) is computed only once per line.
+ *
+ *  With the "memory" backend, rows are kept in a DataTable rather than written out as text,
+ *  so they can be read back later in the same run: from scripts with GET / COLUMN, or from
+ *  C++ through GetTable().  Setting max_rows keeps only the most recent rows; lowering it
+ *  during a run drops the oldest rows, and columns added later read as NaN for earlier rows.
+ *
+ *  With the "shared" backend, each row replaces the values in a POSIX shared-memory segment
+ *  named after the filename (see SharedExport.hpp), so a monitoring process can follow a run
+ *  live.  Non-numeric values are exported as NaN.  DataFile only sees SharedExportBase, so the
+ *  host program must include SharedExport.hpp to make this backend available.
+ *
+ *  If given an OutputPool, text files (other than cout / cerr) are written through it, so a
+ *  run with many DataFiles keeps only a limited number of descriptors open at once.
  */
 
 #ifndef EMPLODE_DATA_FILE_HPP
 #define EMPLODE_DATA_FILE_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
 
 #include "emp/base/Ptr.hpp"
 #include "emp/base/vector.hpp"
+#include "emp/data/Datum.hpp"
 #include "emp/io/StreamManager.hpp"
+#include "emp/tools/string_utils.hpp"
 
+#include "DataTable.hpp"
 #include "EmplodeType.hpp"
+#include "OutputPool.hpp"
+#include "SharedExportBase.hpp"
+#include "ThreadPool.hpp"
 
 namespace emplode {
 
   /// A DataFile maintains an output file that has specified columns and can be generate
   /// dynamically.
   class DataFile : public EmplodeType {
+  public:
+    enum class Backend { TEXT_FILE, MEMORY, SHARED };
+
   private:
-    using data_fun_t = std::function<std::string()>;
+    using data_fun_t = std::function<emp::Datum()>;
     using setup_fun_t = std::function<void()>;
     struct ColumnInfo {
       std::string header;
       data_fun_t fun;
+      bool is_pure = false;             ///< Can this column be evaluated concurrently?
+      bool quote_text = false;          ///< Should non-numeric strings be quoted in the file?
     };
 
     std::string name="";                 ///< Unique name for this object.
     emp::Ptr<emp::StreamManager> files;  ///< Global file manager.
+    emp::Ptr<OutputPool> output_pool;    ///< Shared output for files (null = use file manager).
 
     std::string filename;                ///< Name of output file.
     emp::vector<ColumnInfo> cols;        ///< Data about columns maintainted.
     emp::vector<setup_fun_t> setup;      ///< Commands to run before writing columns.
 
+    std::shared_ptr<ThreadPool> pool;    ///< Threads for pure columns (null = run serially).
+    emp::vector<size_t> pure_ids;        ///< Which columns are pure?
+    emp::vector<emp::Datum> results;     ///< Column output for the line being written.
+
+    Backend backend = Backend::TEXT_FILE;
+    size_t max_rows = 0;                 ///< Rows to keep in memory (0 = all).
+    DataTable table;                     ///< Rows stored by the memory backend.
+    std::shared_ptr<SharedExportBase> shared;  ///< Segment used by the shared backend.
+    emp::vector<double> shared_row;      ///< Numeric version of the row being exported.
+
+    size_t RequireColumn(const std::string & col_name) const {
+      const size_t col_id = table.GetColumnID(col_name);
+      if (col_id == table.GetNumCols()) {
+        std::cerr << "Error: DataFile '" << name << "' has no column '" << col_name
+                  << "' in memory." << std::endl;
+        exit(1);
+      }
+      return col_id;
+    }
+
+    static bool IsStandardStream(const std::string & name) {
+      return name == "cout" || name == "stdout" || name == "cerr" || name == "stderr";
+    }
+
+    void AppendHeaders(std::string & line) const {
+      for (size_t i = 0; i < cols.size(); ++i) {
+        if (i) line += ',';
+        line += cols[i].header;
+      }
+      line += '\n';
+    }
+
+    void AppendResults(std::string & line) const {
+      for (size_t i = 0; i < cols.size(); ++i) {
+        if (i) line += ',';
+        const emp::Datum & value = results[i];
+        if (value.IsDouble()) line += value.AsString();
+        else if (cols[i].quote_text && !emp::is_number(value.NativeString())) {
+          line += emp::to_literal(value.NativeString());
+        }
+        else line += value.NativeString();
+      }
+      line += '\n';
+    }
+
+    /// Write the current results as text.
+    void WriteText() {
+      std::string line;
+      if (output_pool && !IsStandardStream(filename)) {
+        if (!output_pool->Has(filename)) AppendHeaders(line);  // New file needs headers.
+        AppendResults(line);
+        output_pool->Write(filename, line);
+        return;
+      }
+
+      const bool file_exists = files->Has(filename);           // Is file is already setup?
+      std::ostream & file = files->GetOutputStream(filename);  // File to write to.
+      if (!file_exists) AppendHeaders(line);
+      AppendResults(line);
+      file << line << std::flush;
+    }
+
+    /// Store the current results in the in-memory table.
+    void WriteMemory() {
+      // Bring the table up to date if the columns or the row limit have changed; history is kept
+      // for columns that are still present (see DataTable::SetColumns).
+      bool same_cols = table.GetNumCols() == cols.size();
+      for (size_t i = 0; same_cols && i < cols.size(); ++i) {
+        same_cols = table.GetColumnName(i) == cols[i].header;
+      }
+      if (!same_cols) {
+        emp::vector<std::string> headers;
+        for (const ColumnInfo & col : cols) headers.push_back(col.header);
+        table.SetColumns(headers);
+      }
+      table.SetMaxRows(max_rows);
+      table.AddRow(results);
+    }
+
+    /// Publish the current results to shared memory.
+    void WriteShared() {
+      // Start a new segment if we don't have one for the current columns.
+      const std::string segment_name = SharedExportBase::ToSegmentName(filename);
+      if (!shared || shared->GetNumValues() != cols.size() || shared->GetSegmentName() != segment_name) {
+        shared = nullptr;                // Release the old segment before claiming a new one.
+        shared = SharedExportBase::Make(filename);
+        if (!shared) {
+          std::cerr << "Error: DataFile '" << name << "' uses the shared backend, but this "
+                    << "program was not built with it (include Emplode/SharedExport.hpp)." << std::endl;
+          exit(1);
+        }
+        for (const ColumnInfo & col : cols) shared->AddValue(col.header);
+      }
+      shared_row.resize(results.size());
+      for (size_t i = 0; i < results.size(); ++i) {
+        const emp::Datum & value = results[i];
+        if (value.IsDouble()) shared_row[i] = value.NativeDouble();
+        else if (emp::is_number(value.NativeString())) shared_row[i] = value.AsDouble();
+        else shared_row[i] = std::nan("");
+      }
+      shared->Publish(shared_row);
+    }
+
   public:
     DataFile() = delete;
-    DataFile(const std::string & in_name, emp::StreamManager & _files)
-      : name(in_name), files(&_files) { }
+    DataFile(const std::string & in_name, emp::StreamManager & _files,
+             emp::Ptr<OutputPool> _pool=nullptr)
+      : name(in_name), files(&_files), output_pool(_pool) { }
     DataFile(const DataFile &) = default;
     ~DataFile() { }
 
     DataFile & operator=(const DataFile &) = default;
 
     std::string GetName() const { return name; }
+    size_t GetNumColumns() const { return cols.size(); }
+    const std::string & GetFilename() const { return filename; }
+    void SetFilename(const std::string & in_filename) { filename = in_filename; }
 
     // Setup member functions associated with population.
     static void InitType(TypeInfo & info) {
-      info.AddMemberFunction("NUM_COLS",
-        [](DataFile & df) { return df.cols.size(); },
-        "Return the number of columns in this file.");
-      info.AddMemberFunction("WRITE",
-        [](DataFile & df) { return df.Write(); },
-        "Add on the next line of data.");
+      static constexpr std::tuple members{
+        MemberFun<&DataFile::GetNumColumns>{"NUM_COLS",
+          "Return the number of columns in this file."},
+        MemberFun<&DataFile::Write>{"WRITE",
+          "Add on the next line of data."},
+        MemberFun<&DataFile::SetThreadsFromScript>{"SET_THREADS",
+          "Set the number of threads used to evaluate pure columns (1 = serial); returns the number used."},
+        MemberFun<[](DataFile & df) { return df.table.GetNumRows(); }>{"NUM_ROWS",
+          "Return the number of rows held in memory."},
+        MemberFun<&DataFile::Get>{"GET",
+          "Return a value held in memory.  Args: column name, row (0 = oldest, -1 = newest)"},
+        MemberFun<&DataFile::GetColumnList>{"COLUMN",
+          "Return a list of all values held in memory for the named column."},
+      };
+      info.AddMembers(members);
     }
 
     void SetupConfig() override {
       LinkVar(filename, "filename", "Name to use for this file.");
+      LinkMenu(backend, "backend", "Where should rows be stored?",
+               Backend::TEXT_FILE, "file", "Write each row as a line of text to the file.",
+               Backend::MEMORY, "memory", "Keep rows in memory to be read back during the run.",
+               Backend::SHARED, "shared", "Publish the latest row to shared memory named by filename.");
+      LinkVar(max_rows, "max_rows", "With the memory backend, keep only this many recent rows (0 = all).");
+    }
+
+    Backend GetBackend() const { return backend; }
+    void SetBackend(Backend in_backend) { backend = in_backend; }
+    void SetMaxRows(size_t in_max) { max_rows = in_max; }
+
+    /// Rows kept by the memory backend.
+    const DataTable & GetTable() const { return table; }
+
+    /// Look up a value stored in memory; negative rows count back from the newest row.
+    emp::Datum Get(const std::string & col_name, double row) const {
+      const size_t col_id = RequireColumn(col_name);
+      const double num_rows = static_cast<double>(table.GetNumRows());
+      if (row < 0.0) row += num_rows;
+      if (!(row >= 0.0 && row < num_rows)) {
+        std::cerr << "Error: row " << row << " out of range for DataFile '" << name
+                  << "' (" << num_rows << " rows in memory)." << std::endl;
+        exit(1);
+      }
+      return table.Get(col_id, static_cast<size_t>(row));
+    }
+
+    /// Build a temporary list symbol holding every value of a column stored in memory.
+    emp::Ptr<Symbol> GetColumnList(const std::string & col_name) const {
+      const size_t col_id = RequireColumn(col_name);
+      auto list = emp::NewPtr<Symbol_List>();
+      list->SetTemporary();
+      for (size_t row = 0; row < table.GetNumRows(); ++row) {
+        list->Push(emp::NewPtr<Symbol_Var>(table.Get(col_id, row)));
+      }
+      return list;
     }
 
-    size_t AddColumn(const std::string & header, data_fun_t fun) {
+    /// Add a column; pure columns must be side-effect free and safe to call from any thread.
+    /// If quote_text is set, non-numeric strings are written to the file as quoted literals.
+    size_t AddColumn(const std::string & header, data_fun_t fun,
+                     bool is_pure=false, bool quote_text=false) {
       size_t col_id = cols.size();
-      cols.push_back(ColumnInfo{header,fun});
+      cols.push_back(ColumnInfo{header,fun,is_pure,quote_text});
+      if (is_pure) pure_ids.push_back(col_id);
       return col_id;
     }
 
+    /// Most threads a DataFile will use: one per hardware thread.
+    static size_t GetMaxThreads() {
+      return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    /// Evaluate pure columns on num_threads threads (capped at GetMaxThreads()); 0 or 1 turns
+    /// parallel evaluation off.  Returns the number of threads actually used.
+    size_t SetNumThreads(size_t num_threads) {
+      num_threads = std::min(num_threads, GetMaxThreads());
+      if (num_threads <= 1) pool.reset();
+      else if (!pool || pool->GetNumThreads() != num_threads) {
+        pool = std::make_shared<ThreadPool>(num_threads);
+      }
+      return GetNumThreads();
+    }
+
+    /// SET_THREADS from a script: the count must be a whole number of at least 1.
+    size_t SetThreadsFromScript(double num_threads) {
+      if (!(num_threads >= 1.0) || num_threads != std::floor(num_threads)) {
+        std::cerr << "Error: DataFile '" << name << "' SET_THREADS needs a whole number of at "
+                  << "least 1 (given " << num_threads << ")." << std::endl;
+        exit(1);
+      }
+      const double max_threads = static_cast<double>(GetMaxThreads());
+      return SetNumThreads(static_cast<size_t>(std::min(num_threads, max_threads)));
+    }
+
+    size_t GetNumThreads() const { return pool ? pool->GetNumThreads() : 1; }
+
     size_t AddSetup(setup_fun_t fun) {
       size_t setup_id = setup.size();
       setup.push_back(fun);
@@ -78,27 +302,24 @@ namespace emplode {
     }
 
     size_t Write() {
-      const bool file_exists = files->Has(filename);           // Is file is already setup?
-      std::ostream & file = files->GetOutputStream(filename);  // File to write to.
-
-      // If we need headers, set them up!
-      if (!file_exists) {
-        for (size_t i = 0; i < cols.size(); ++i) {
-          if (i) file << ",";
-          file << cols[i].header;
-        }
-        file << std::endl;
-      }
-
       // Do any setup for the columns.
       for (auto fun : setup) fun();
 
-      // Now print out each entry.
+      // Evaluate pure columns concurrently (if we have threads) and the rest in order.
+      results.resize(cols.size());
+      const bool run_parallel = pool && pure_ids.size() > 1;
+      if (run_parallel) {
+        pool->ParallelFor(pure_ids.size(), [this](size_t id){
+          results[pure_ids[id]] = cols[pure_ids[id]].fun();
+        });
+      }
       for (size_t i = 0; i < cols.size(); ++i) {
-        if (i) file << ",";
-        file << cols[i].fun();
+        if (!run_parallel || !cols[i].is_pure) results[i] = cols[i].fun();
       }
-      file << std::endl;
+
+      if (backend == Backend::MEMORY) WriteMemory();
+      else if (backend == Backend::SHARED) WriteShared();
+      else WriteText();
 
       return 1;
     }
@@ -0,0 +1,203 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  DataTable.hpp
+ *  @brief In-memory table of rows, stored as one typed vector per column.
+ *  @note Status: BETA
+ *
+ *  A column is numeric until it receives a value that is not a number, at which point it is
+ *  converted to hold strings.  The table may be limited to the most recent N rows, in which
+ *  case it acts as a ring buffer: once full, each new row replaces the oldest one.
+ *
+ *  Row 0 is always the oldest row kept.  Column data can be read without copying through
+ *  GetNumbers() / GetStrings(), which return the (at most two) contiguous pieces of the
+ *  column in row order.
+ *
+ *  Neither changing the row limit nor changing the columns discards history: a smaller limit
+ *  keeps the newest rows, columns that stay (matched by name) keep their values, and a new
+ *  column holds NaN for the rows written before it existed.
+ */
+
+#ifndef EMPLODE_DATA_TABLE_HPP
+#define EMPLODE_DATA_TABLE_HPP
+
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/vector.hpp"
+#include "emp/data/Datum.hpp"
+#include "emp/tools/string_utils.hpp"
+
+namespace emplode {
+
+  class DataTable {
+  public:
+    template <typename T>
+    using span_pair_t = std::pair<std::span<const T>, std::span<const T>>;
+
+  private:
+    struct Column {
+      std::string name;
+      bool is_numeric = true;
+      emp::vector<double> numbers{};
+      emp::vector<std::string> strings{};
+
+      /// Switch this column over to storing strings.
+      void ConvertToStrings() {
+        strings.resize(numbers.size());
+        for (size_t i = 0; i < numbers.size(); ++i) strings[i] = emp::to_string(numbers[i]);
+        numbers.clear();
+        is_numeric = false;
+      }
+
+      void Set(size_t pos, const emp::Datum & value) {
+        if (is_numeric && value.IsString() && !emp::is_number(value.NativeString())) {
+          ConvertToStrings();
+        }
+        if (is_numeric) {
+          if (pos == numbers.size()) numbers.push_back(value.AsDouble());
+          else numbers[pos] = value.AsDouble();
+        } else {
+          if (pos == strings.size()) strings.push_back(value.AsString());
+          else strings[pos] = value.AsString();
+        }
+      }
+    };
+
+    emp::vector<Column> columns;
+    size_t max_rows = 0;      ///< Maximum rows to keep (0 = unlimited).
+    size_t num_rows = 0;      ///< Rows currently stored.
+    size_t start = 0;         ///< Storage position of row 0 (non-zero only once a ring is full).
+
+    size_t ToPos(size_t row) const {
+      emp_assert(row < num_rows, row, num_rows);
+      const size_t pos = start + row;
+      return (pos < num_rows) ? pos : pos - num_rows;
+    }
+
+    /// Store rows in order (row 0 first), keeping only the newest keep_rows of them.
+    void Straighten(size_t keep_rows) {
+      const size_t drop = num_rows - keep_rows;
+      for (Column & column : columns) {
+        if (column.is_numeric) {
+          std::rotate(column.numbers.begin(), column.numbers.begin() + start, column.numbers.end());
+          column.numbers.erase(column.numbers.begin(), column.numbers.begin() + drop);
+        } else {
+          std::rotate(column.strings.begin(), column.strings.begin() + start, column.strings.end());
+          column.strings.erase(column.strings.begin(), column.strings.begin() + drop);
+        }
+      }
+      num_rows = keep_rows;
+      start = 0;
+    }
+
+    /// A column with no values for the rows already stored.
+    Column MakeEmptyColumn(const std::string & name) const {
+      return Column{name, true, emp::vector<double>(num_rows, std::numeric_limits<double>::quiet_NaN())};
+    }
+
+    template <typename T>
+    span_pair_t<T> Split(const emp::vector<T> & values) const {
+      std::span<const T> all(values.data(), values.size());
+      return { all.subspan(start), all.subspan(0, start) };
+    }
+
+  public:
+    DataTable() = default;
+
+    size_t GetNumRows() const { return num_rows; }
+    size_t GetNumCols() const { return columns.size(); }
+    size_t GetMaxRows() const { return max_rows; }
+    const std::string & GetColumnName(size_t col) const { return columns[col].name; }
+    bool IsNumeric(size_t col) const { return columns[col].is_numeric; }
+
+    /// Find a column by name; returns GetNumCols() if there is no such column.
+    size_t GetColumnID(const std::string & name) const {
+      for (size_t i = 0; i < columns.size(); ++i) if (columns[i].name == name) return i;
+      return columns.size();
+    }
+
+    /// Add a column; any rows already stored hold NaN in it.
+    size_t AddColumn(const std::string & name) {
+      columns.push_back(MakeEmptyColumn(name));
+      return columns.size() - 1;
+    }
+
+    /// Change the columns to the given names, in order.  Columns whose name is kept (the first
+    /// unused match, if names repeat) keep their values; other columns are removed.
+    void SetColumns(const emp::vector<std::string> & names) {
+      emp::vector<Column> old_columns = std::move(columns);
+      emp::vector<bool> used(old_columns.size(), false);
+      columns.clear();
+      for (const std::string & name : names) {
+        size_t old_id = 0;
+        while (old_id < old_columns.size() && (used[old_id] || old_columns[old_id].name != name)) {
+          ++old_id;
+        }
+        if (old_id < old_columns.size()) {
+          used[old_id] = true;
+          columns.push_back(std::move(old_columns[old_id]));
+        }
+        else columns.push_back(MakeEmptyColumn(name));
+      }
+    }
+
+    /// Limit the table to the most recent rows (0 = unlimited); if the new limit is smaller
+    /// than the number of rows stored, only the newest rows are kept.
+    void SetMaxRows(size_t in_max) {
+      if (in_max == max_rows) return;
+      Straighten((in_max && num_rows > in_max) ? in_max : num_rows);
+      max_rows = in_max;
+    }
+
+    /// Remove all rows (columns are kept and become numeric again).
+    void Clear() {
+      for (Column & column : columns) {
+        column.is_numeric = true;
+        column.numbers.clear();
+        column.strings.clear();
+      }
+      num_rows = 0;
+      start = 0;
+    }
+
+    /// Add a row with one value per column.
+    void AddRow(const emp::vector<emp::Datum> & row) {
+      emp_assert(row.size() == columns.size(), row.size(), columns.size());
+      size_t pos = num_rows;
+      if (max_rows && num_rows == max_rows) {  // Full ring; replace the oldest row.
+        pos = start;
+        if (++start == max_rows) start = 0;
+      }
+      else ++num_rows;
+      for (size_t col = 0; col < columns.size(); ++col) columns[col].Set(pos, row[col]);
+    }
+
+    emp::Datum Get(size_t col, size_t row) const {
+      const Column & column = columns[col];
+      if (column.is_numeric) return column.numbers[ToPos(row)];
+      return column.strings[ToPos(row)];
+    }
+
+    /// A numeric column, in row order, as up to two contiguous pieces.
+    span_pair_t<double> GetNumbers(size_t col) const {
+      emp_assert(columns[col].is_numeric, col);
+      return Split(columns[col].numbers);
+    }
+
+    /// A string column, in row order, as up to two contiguous pieces.
+    span_pair_t<std::string> GetStrings(size_t col) const {
+      emp_assert(!columns[col].is_numeric, col);
+      return Split(columns[col].strings);
+    }
+  };
+
+}
+
+#endif
@@ -70,7 +70,9 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "emp/base/assert.hpp"
@@ -81,11 +83,15 @@
 #include "emp/tools/string_utils.hpp"
 
 #include "AST.hpp"
+#include "BuiltinLibrary.hpp"
 #include "DataFile.hpp"
 #include "EmplodeType.hpp"
 #include "EventManager.hpp"
 #include "Lexer.hpp"
+#include "Optimizer.hpp"
+#include "OutputSink.hpp"
 #include "Parser.hpp"
+#include "Random.hpp"
 #include "Symbol_Function.hpp"
 #include "SymbolTable.hpp"
 #include "TypeInfo.hpp"
@@ -102,6 +108,192 @@ namespace emplode {
     Lexer lexer;               ///< Lexer to process input code.
     Parser parser;             ///< Parser to transform token stream into an abstract syntax tree.
     ASTNode_Block ast_root;    ///< Abstract syntax tree version of input file.
+    Random random;             ///< Random numbers for this instance (seed 0, stream 0 by default).
+    OutputSink print_sink;     ///< Destination for PRINT and PRINTF.
+
+    /// Script columns (ADD_COLUMN) of one DataFile.  They are compiled together the first time
+    /// a line is written, so subexpressions repeated across columns are computed once per line.
+    struct ColumnGroup {
+      emp::vector<std::string> expressions;
+      size_t file_cols = 0;                      ///< Columns in the file after the last add.
+      emp::Ptr<ASTNode_Block> block = nullptr;   ///< Compiled columns (null until needed).
+      std::shared_ptr<ReuseRegion> region = std::make_shared<ReuseRegion>();
+
+      ~ColumnGroup() { if (block) block.Delete(); }
+    };
+    emp::vector<emp::Ptr<ColumnGroup>> column_groups;   ///< All column groups (owned here).
+    std::unordered_map<const DataFile *, emp::Ptr<ColumnGroup>> file_columns;  ///< By file.
+
+    /// Convert the (optional) count argument of a random function; -1 if not provided.
+    static int64_t GetDrawCount(const emp::vector<emp::Ptr<Symbol>> & args, size_t count_pos,
+                                const std::string & fun_name) {
+      if (args.size() <= count_pos) return -1;
+      const double count = args[count_pos]->AsDouble();
+      if (count < 0.0 || count != std::floor(count)) {
+        std::cerr << "Error: count for " << fun_name << " must be a non-negative integer; received "
+                  << count << "." << std::endl;
+        exit(1);
+      }
+      return static_cast<int64_t>(count);
+    }
+
+    /// Return a single draw as a number, or a list of 'count' draws.
+    template <typename FUN_T>
+    emp::Ptr<Symbol> MakeDraws(int64_t count, FUN_T draw_fun) {
+      if (count < 0) return symbol_table.MakeTempSymbol(static_cast<double>(draw_fun()));
+      auto list = emp::NewPtr<Symbol_List>();
+      list->SetTemporary();
+      for (int64_t i = 0; i < count; ++i) {
+        list->Push(emp::NewPtr<Symbol_Var>(static_cast<double>(draw_fun())));
+      }
+      return list;
+    }
+
+    static emp::Ptr<Symbol_List> RequireList(emp::Ptr<Symbol> arg, const std::string & fun_name) {
+      auto list = arg.DynamicCast<Symbol_List>();
+      if (!list) {
+        std::cerr << "Error in call to function '" << fun_name << "'; first argument must be a list."
+                  << std::endl;
+        exit(1);
+      }
+      return list;
+    }
+
+    /// Add the random number functions, which all share this instance's stream.
+    void SetupRandomFunctions() {
+      using args_t = const emp::vector<emp::Ptr<Symbol>> &;
+
+      AddFunction("RANDOM", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {0, 2, 3}, "RANDOM");
+        const double min = args.size() ? args[0]->AsDouble() : 0.0;
+        const double max = args.size() ? args[1]->AsDouble() : 1.0;
+        return MakeDraws(GetDrawCount(args, 2, "RANDOM"),
+                         [this,min,max](){ return random.GetDouble(min, max); });
+      }, "Uniform random value in [0,1), or in [arg1,arg2); optional arg3 gives a list of draws");
+
+      AddFunction("RANDOM_INT", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {1, 2, 3}, "RANDOM_INT");
+        const double min = (args.size() > 1) ? args[0]->AsDouble() : 0.0;
+        const double max = (args.size() > 1) ? args[1]->AsDouble() : args[0]->AsDouble();
+        const int64_t imin = static_cast<int64_t>(std::ceil(min));
+        const int64_t imax = static_cast<int64_t>(std::ceil(max));
+        if (!(imin < imax)) {   // e.g., [1.2,1.8) holds no integers.
+          std::cerr << "Error: RANDOM_INT range [" << min << "," << max << ") has no integers."
+                    << std::endl;
+          exit(1);
+        }
+        return MakeDraws(GetDrawCount(args, 2, "RANDOM_INT"),
+                         [this,imin,imax](){ return random.GetInt(imin, imax); });
+      }, "Random integer in [0,arg1) or [arg1,arg2); optional arg3 gives a list of draws");
+
+      AddFunction("NORMAL", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {0, 2, 3}, "NORMAL");
+        const double mean = args.size() ? args[0]->AsDouble() : 0.0;
+        const double std = args.size() ? args[1]->AsDouble() : 1.0;
+        return MakeDraws(GetDrawCount(args, 2, "NORMAL"),
+                         [this,mean,std](){ return random.GetNormal(mean, std); });
+      }, "Normal random value (default mean 0, std 1; or arg1, arg2); optional arg3 gives a list");
+
+      AddFunction("POISSON", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {1, 2}, "POISSON");
+        const double mean = args[0]->AsDouble();
+        if (mean < 0.0) {
+          std::cerr << "Error: POISSON mean must be non-negative; received " << mean << "." << std::endl;
+          exit(1);
+        }
+        return MakeDraws(GetDrawCount(args, 1, "POISSON"),
+                         [this,mean](){ return random.GetPoisson(mean); });
+      }, "Poisson random count with mean arg1; optional arg2 gives a list of draws");
+
+      AddFunction("SHUFFLE", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {1}, "SHUFFLE");
+        auto list = RequireList(args[0], "SHUFFLE");
+        emp::vector<emp::Ptr<Symbol>> values(list->GetValues());
+        random.Shuffle(values);
+        auto out = emp::NewPtr<Symbol_List>();
+        out->SetTemporary();
+        for (auto value : values) out->Push(value->ShallowClone());
+        return emp::Ptr<Symbol>(out);
+      }, "Return a copy of the list (arg1) in random order");
+
+      AddFunction("CHOOSE", [this](args_t args){
+        BuiltinLibrary::RequireArgs(args, {1, 2}, "CHOOSE");
+        auto list = RequireList(args[0], "CHOOSE");
+        const auto & values = list->GetValues();
+        const int64_t count = GetDrawCount(args, 1, "CHOOSE");
+        if ((values.size() == 0 && count < 0) || count > static_cast<int64_t>(values.size())) {
+          std::cerr << "Error: CHOOSE cannot pick " << ((count < 0) ? 1 : count)
+                    << " value(s) from a list of size " << values.size() << "." << std::endl;
+          exit(1);
+        }
+        if (count < 0) {
+          emp::Ptr<Symbol> out = values[random.GetUInt(values.size())]->ShallowClone();
+          out->SetTemporary();
+          return out;
+        }
+
+        // Pick 'count' distinct positions with a partial Fisher-Yates shuffle.
+        emp::vector<size_t> ids(values.size());
+        for (size_t i = 0; i < ids.size(); ++i) ids[i] = i;
+        auto out = emp::NewPtr<Symbol_List>();
+        out->SetTemporary();
+        for (size_t i = 0; i < static_cast<size_t>(count); ++i) {
+          std::swap(ids[i], ids[i + random.GetUInt(ids.size() - i)]);
+          out->Push(values[ids[i]]->ShallowClone());
+        }
+        return emp::Ptr<Symbol>(out);
+      }, "Random element of list arg1; optional arg2 gives a list of that many distinct elements");
+
+      AddFunction("SET_RANDOM_SEED", [this](double seed){
+        random.ResetSeed(static_cast<uint64_t>(seed), random.GetStream());
+        return seed;
+      }, "Restart this instance's random number stream from the provided seed.");
+    }
+
+    /// Convert the result of a script to a datum (numeric if possible).
+    static emp::Datum ToDatum(const Value & value) {
+      if (!value) return emp::Datum();
+      if (value->IsNumeric()) return emp::Datum(value->AsDouble());
+      return emp::Datum(value->AsString());
+    }
+
+    /// Find the group for new script columns of a file.  A new group is started if script
+    /// columns are not the last ones added (or the group belonged to an earlier file).
+    ColumnGroup & GetColumnGroup(const DataFile & file) {
+      emp::Ptr<ColumnGroup> & group = file_columns[&file];
+      if (!group || group->file_cols != file.GetNumColumns()) {
+        group = emp::NewPtr<ColumnGroup>();
+        column_groups.push_back(group);
+      }
+      return *group;
+    }
+
+    void CompileColumns(ColumnGroup & group) {
+      group.block = emp::NewPtr<ASTNode_Block>(symbol_table.GetRootScope(), 0);
+      group.block->SetSymbolTable(symbol_table);
+      emp::vector<emp::Ptr<ASTNode>> columns;
+      for (const std::string & expression : group.expressions) {
+        // Parse each column as a statement, just as Execute() does.
+        emp::TokenStream tokens = lexer.Tokenize(expression, "DataFile column");
+        tokens.push_back(lexer.ToToken(";"));
+        pos_t pos = tokens.begin();
+        ParseState state{pos, symbol_table, symbol_table.GetRootScope(), lexer};
+        emp::Ptr<ASTNode> column = parser.ParseStatement(state);
+        if (!column) state.Error("DataFile column '", expression, "' has nothing to compute.");
+        columns.push_back(column);
+      }
+      parser.GetOptimizer().ShareSubexpressions(columns, group.region);
+      for (auto column : columns) group.block->AddChild(column);
+    }
+
+    emp::Datum EvalColumn(ColumnGroup & group, size_t id) {
+      if (!group.block) CompileColumns(group);
+      if (id == 0) ++group.region->epoch;        // Columns run in order; a line starts at 0.
+      symbol_table.BeginRun();
+      Value result = group.block->GetChild(id)->Process();
+      symbol_table.EndRun();
+      return ToDatum(result);
+    }
 
     std::string ConcatLexemes(pos_t start_pos, pos_t end_pos) const {
       emp_assert(start_pos <= end_pos);
@@ -131,74 +323,56 @@ namespace emplode {
       AddFunction("EXEC", exec_fun, "Dynamically execute the string passed in.");
 
       // 'PRINT' is a simple debugging command to output the value of a variable.
-      auto print_fun = [](const emp::vector<emp::Ptr<Symbol>> & args) {
-        for (auto entry_ptr : args) entry_ptr->Print(std::cout);
-        std::cout << std::endl;
+      auto print_fun = [this](const emp::vector<emp::Ptr<Symbol>> & args) {
+        std::string line;
+        for (auto entry_ptr : args) OutputSink::AppendSymbol(line, *entry_ptr);
+        line += '\n';
+        print_sink.Write(line);
         return 0;
       };
       AddFunction("PRINT", print_fun, "Print out the provided variables.");
 
-      // Default 1-input math functions
-      AddFunction("ABS", [](double x){ return std::abs(x); }, "Absolute Value" );
-      AddFunction("EXP", [](double x){ return emp::Pow(emp::E, x); }, "Exponentiation" );
-      AddFunction("LOG2", [](double x){ return std::log(x); }, "Log base-2" );
-      AddFunction("LOG10", [](double x){ return std::log10(x); }, "Log base-10" );
-
-      AddFunction("SQRT", [](double x){ return std::sqrt(x); }, "Square Root" );
-      AddFunction("CBRT", [](double x){ return std::cbrt(x); }, "Cube Root" );
-
-      AddFunction("SIN", [](double x){ return std::sin(x); }, "Sine" );
-      AddFunction("COS", [](double x){ return std::cos(x); }, "Cosine" );
-      AddFunction("TAN", [](double x){ return std::tan(x); }, "Tangent" );
-      AddFunction("ASIN", [](double x){ return std::asin(x); }, "Arc Sine" );
-      AddFunction("ACOS", [](double x){ return std::acos(x); }, "Arc Cosine" );
-      AddFunction("ATAN", [](double x){ return std::atan(x); }, "Arc Tangent" );
-      AddFunction("SINH", [](double x){ return std::sinh(x); }, "Hyperbolic Sine" );
-      AddFunction("COSH", [](double x){ return std::cosh(x); }, "Hyperbolic Cosine" );
-      AddFunction("TANH", [](double x){ return std::tanh(x); }, "Hyperbolic Tangent" );
-      AddFunction("ASINH", [](double x){ return std::asinh(x); }, "Hyperbolic Arc Sine" );
-      AddFunction("ACOSH", [](double x){ return std::acosh(x); }, "Hyperbolic Arc Cosine" );
-      AddFunction("ATANH", [](double x){ return std::atanh(x); }, "Hyperbolic Arc Tangent" );
-
-      AddFunction("CEIL", [](double x){ return std::ceil(x); }, "Round UP" );
-      AddFunction("FLOOR", [](double x){ return std::floor(x); }, "Round DOWN" );
-      AddFunction("ROUND", [](double x){ return std::round(x); }, "Round to nearest" );
-
-      AddFunction("ISINF", [](double x){ return std::isinf(x); }, "Test if Infinite" );
-      AddFunction("ISNAN", [](double x){ return std::isnan(x); }, "Test if Not-a-number" );
-
-      // Default 2-input math functions
-      AddFunction("HYPOT", [](double x, double y){ return std::hypot(x,y); }, "Given sides, find hypotenuse" );
-      AddFunction("LOG", [](double x, double y){ return emp::Pow(x,y); }, "Take log of arg1 with base arg2" );
-      AddFunction("MIN", [](double x, double y){ return (x<y) ? x : y; }, "Return lesser value" );
-      AddFunction("MAX", [](double x, double y){ return (x>y) ? x : y; }, "Return greater value" );
-      AddFunction("POW", [](double x, double y){ return emp::Pow(x,y); }, "Take arg1 to the arg2 power" );
-
-      // Default 3-input math functions
-      AddFunction("IF", [](double x, double y, double z){ return (x!=0.0) ? y : z; },
-                  "If arg1 is true, return arg2, else arg3" );
-      AddFunction("CLAMP", [](double x, double y, double z){ return (x<y) ? y : (x>z) ? z : x; },
-                  "Return arg1, forced into range [arg2,arg3]" );
-      AddFunction("TO_SCALE", [](double x, double y, double z){ return (z-y)*x+y; },
-                  "Scale arg1 to arg2-arg3 as unit distance" );
-      AddFunction("FROM_SCALE", [](double x, double y, double z){ return (x-y) / (z-y); },
-                  "Scale arg1 from arg2-arg3 as unit distance" );
+      // 'PRINTF' prints values using a C-style format string (no newline is added).
+      auto printf_fun = [this](const emp::vector<emp::Ptr<Symbol>> & args) {
+        if (args.size() == 0) {
+          std::cerr << "Error: PRINTF requires a format string." << std::endl;
+          exit(1);
+        }
+        std::string out;
+        const std::string format = args[0]->AsString();
+        OutputSink::AppendPrintf(out, format, args, 1);
+        print_sink.Write(out);
+        return out.size();
+      };
+      AddFunction("PRINTF", printf_fun,
+                  "Print values using a format string.  Args: format, values (e.g., \"%5.2f\")");
+
+      // Math functions are provided by the shared BuiltinLibrary (see BuiltinLibrary.hpp).
+
+      // Random functions are per-instance since each instance has its own generator.
+      SetupRandomFunctions();
 
       // Setup default DataFile type.
       auto df_init = [this](const std::string & name) {
-        return emp::NewPtr<DataFile>(name, symbol_table.GetFileManager());
+        return emp::NewPtr<DataFile>(name, symbol_table.GetFileManager(),
+                                     &symbol_table.GetOutputPool());
       };
       auto df_copy = symbol_table.DefaultCopyFun<DataFile>();
       auto & df_type = AddType<DataFile>("DataFile", "Manage CSV-style data file output.",
                                          df_init, df_copy, true);
       df_type.AddMemberFunction(
         "ADD_COLUMN",
-        [exec_fun](DataFile & file, const std::string & title, const std::string & expression){
-          return file.AddColumn(title, [exec_fun,expression](){
-            std::string out_string = exec_fun(expression);
-            if (!emp::is_number(out_string)) return emp::to_literal(out_string);
-            return out_string;
-          });
+        [this](DataFile & file, const std::string & title, const std::string & expression){
+          emp::Ptr<ColumnGroup> group = &GetColumnGroup(file);
+          const size_t id = group->expressions.size();
+          group->expressions.push_back(expression);
+          if (group->block) group->block.Delete();     // Recompile with the new column.
+          group->block = nullptr;
+          const size_t col_id = file.AddColumn(title, [this, group, id](){
+            return EvalColumn(*group, id);
+          }, false, true);
+          group->file_cols = file.GetNumColumns();
+          return col_id;
         },
         "Add a column to the associated DataFile.  Args: title, string to execute for result"
       );
@@ -211,6 +385,10 @@ namespace emplode {
       );
     }
 
+    ~Emplode() {
+      for (auto group : column_groups) group.Delete();
+    }
+
     // Prevent copy or move since we are using lambdas that capture 'this'
     Emplode(const Emplode &) = delete;
     Emplode(Emplode &&) = delete;
@@ -219,8 +397,34 @@ namespace emplode {
 
     void PrintAST() { ast_root.PrintAST(); }
 
+    /// Optimization passes run as code is parsed (see Optimizer.hpp).
+    Optimizer & GetOptimizer() { return parser.GetOptimizer(); }
+
+    /// Limit how many DataFile outputs may be open at once; others are closed (least recently
+    /// written first) and reopened in append mode when they next have data.
+    void SetMaxOpenFiles(size_t max_open) { symbol_table.GetOutputPool().SetMaxOpen(max_open); }
+
+    /// Write out all buffered DataFile output (it is otherwise held until buffers fill).
+    void FlushFiles() { symbol_table.GetOutputPool().Flush(); }
+
     /// Create a new type of event that can be used in the scripting language.
-    bool AddSignal(const std::string & name) { return symbol_table.AddSignal(name); }
+    bool AddSignal(const std::string & name, int num_params=-1) {
+      return symbol_table.AddSignal(name, num_params);
+    }
+
+    /// Limit how many steps (loop iterations and user function calls) a single run of script code
+    /// may take before being aborted as a runaway; 0 means unlimited.
+    void SetStepLimit(size_t step_limit) { symbol_table.SetStepLimit(step_limit); }
+
+    /// Limit the steps for each action linked to a signal (overriding the default step limit).
+    bool SetSignalStepLimit(const std::string & name, size_t step_limit) {
+      return symbol_table.SetSignalStepLimit(name, step_limit);
+    }
+
+    /// Queue triggers of a signal (from the host or from scripts) until DeliverTriggers().
+    bool SetSignalDeferred(const std::string & name, bool deferred=true) {
+      return symbol_table.SetSignalDeferred(name, deferred);
+    }
 
     /// Trigger all actions linked to a signal.
     template <typename... ARG_Ts>
@@ -228,11 +432,34 @@ namespace emplode {
       symbol_table.Trigger(name, std::forward<ARG_Ts>(args)...);
     }
 
+    /// Get handles for all actions linked to a signal (in the order they run).
+    emp::vector<size_t> GetActionHandles(const std::string & name) const {
+      return symbol_table.GetActionHandles(name);
+    }
+
+    /// Remove an action so that it is no longer run when its signal is triggered.
+    bool RemoveAction(size_t handle) { return symbol_table.RemoveAction(handle); }
+
+    /// Run the actions for all queued triggers of deferred signals, in batches.
+    void DeliverTriggers() { symbol_table.DeliverTriggers(); }
+
     template <typename... EXTRA_Ts, typename... ARG_Ts>
     TypeInfo & AddType(ARG_Ts &&... args) {
       return symbol_table.AddType<EXTRA_Ts...>( std::forward<ARG_Ts>(args)... );
     }
 
+    /// Add a type whose objects are owned by Emplode and kept in a stable-address ObjectPool.
+    template <typename OBJECT_T, size_t CHUNK_SIZE=256>
+    TypeInfo & AddPooledType(const std::string & type_name, const std::string & desc) {
+      return symbol_table.AddPooledType<OBJECT_T, CHUNK_SIZE>(type_name, desc);
+    }
+
+    /// Access the pool of all live objects for a type added with AddPooledType().
+    template <typename OBJECT_T, size_t CHUNK_SIZE=256>
+    ObjectPool<OBJECT_T, CHUNK_SIZE> & GetPool() {
+      return symbol_table.GetPool<OBJECT_T, CHUNK_SIZE>();
+    }
+
     TypeInfo & GetType(const std::string & type_name) {
       return symbol_table.GetType(type_name);
     }
@@ -250,6 +477,24 @@ namespace emplode {
       symbol_table.AddFunction(name, fun, desc);
     }
 
+    /// Add a function without side effects; see SymbolTable::AddPureFunction().
+    template <typename FUN_T>
+    void AddPureFunction(const std::string & name, FUN_T fun, const std::string & desc,
+                         size_t memo_size=0) {
+      symbol_table.AddPureFunction(name, fun, desc, memo_size);
+    }
+
+    /// Restart this instance's random numbers.  Every instance starts from seed 0 on stream 0,
+    /// so results never depend on how many instances exist or which thread created them; hosts
+    /// running several instances (for example, one per thread) should give each its own stream
+    /// id, such as its index, for independent sequences.
+    void SetRandomSeed(uint64_t seed, uint64_t stream=0) { random.ResetSeed(seed, stream); }
+    Random & GetRandom() { return random; }
+
+    /// Where PRINT and PRINTF output goes (std::cout by default); may be redirected to another
+    /// stream, a file, or a string.
+    OutputSink & GetPrintSink() { return print_sink; }
+
     SymbolTable & GetSymbolTable() { return symbol_table; }
     const SymbolTable & GetSymbolTable() const { return symbol_table; }
 
@@ -268,7 +513,9 @@ namespace emplode {
       ast_root.AddChild(cur_block);
 
       // And process just this new block.
+      symbol_table.BeginRun();
       cur_block->Process();
+      symbol_table.EndRun();
     }
 
     /// Sequentially load a series of configuration files.
@@ -287,7 +534,9 @@ namespace emplode {
       // Parse and run the program, starting from the outer scope.
       ParseState state{pos, symbol_table, symbol_table.GetRootScope(), lexer};
       auto cur_block = parser.ParseStatementList(state);
+      symbol_table.BeginRun();
       cur_block->Process();
+      symbol_table.EndRun();
 
       // Store this AST onto the full set we're working with.
       ast_root.AddChild(cur_block);
@@ -308,13 +557,11 @@ namespace emplode {
       cur_block->AddChild(cur_expr);
 
       // Process just the expressions so that we can get a result from it.
-      auto result_ptr = cur_expr->Process();                // Process AST to get result symbol.
-      emp::Datum result;
-      if (result_ptr) {
-        if (result_ptr->IsNumeric()) result = result_ptr->AsDouble(); // Result is numeric output.
-        else result = result_ptr->AsString();                         // Result is string output.
-        if (result_ptr->IsTemporary()) result_ptr.Delete();           // Delete temp result symbol.
-      }
+      symbol_table.BeginRun();
+      Value result_value = cur_expr->Process();             // Process AST to get result symbol.
+      symbol_table.EndRun();
+      emp::Datum result = ToDatum(result_value);            // Numeric output if possible.
+      result_value.Clear();                                 // Delete temp result symbol.
       cur_block.Delete();                                   // Delete the temporary AST.
       return result;                                        // Return the result string.
     }
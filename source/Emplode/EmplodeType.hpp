@@ -13,6 +13,7 @@
 
 #include "emp/base/assert.hpp"
 
+#include "Symbol_Menu.hpp"
 #include "Symbol_Scope.hpp"
 #include "TypeInfo.hpp"
 
@@ -84,11 +85,21 @@ namespace emplode {
       //           << std::endl;
 
       for (const MemberFunInfo & member_info : member_map) {
-        member_fun_t linked_fun = [this, &member_info](const emp::vector<symbol_ptr_t> & args){
-          return member_info.fun(*this, args);
-        };
-        symbol_ptr->AddFunction(member_info.name, linked_fun,
-                                member_info.desc, member_info.return_type).GetValue()->SetBuiltin();
+        // Functions from a member table go straight to their trampoline; the argument count
+        // is checked by the function symbol, before the call.
+        member_fun_t linked_fun;
+        if (member_info.trampoline) {
+          linked_fun = [this, &member_info](const emp::vector<symbol_ptr_t> & args){
+            return member_info.trampoline(*this, args, *member_info.symbol_table);
+          };
+        } else {
+          linked_fun = [this, &member_info](const emp::vector<symbol_ptr_t> & args){
+            return member_info.fun(*this, args);
+          };
+        }
+        symbol_ptr->AddFunction(member_info.name, linked_fun, member_info.desc,
+                                member_info.return_type, member_info.num_params)
+          .GetValue()->SetBuiltin();
 
         // std::cout << "Adding member function '" << member_info.name << "' to object '"
         //           << symbol_ptr->GetName() << "'." << std::endl;
@@ -133,6 +144,7 @@ namespace emplode {
     /// Link a set of menu option to a variable value.
     /// Each option should include three arguments:
     /// The return value, the option name, and the option description.
+    /// Scripts see the name of the current option; assigning any other name is an error.
     template <typename VAR_T, typename... Ts>
     Var LinkMenu(VAR_T & var,
                  const std::string & name,
@@ -140,23 +152,8 @@ namespace emplode {
                  const Ts &... entries) {
       auto menu = emp::BuildObjVector<MenuEntry<VAR_T>, 3>(entries...);
 
-      // Build the "get" function: take the current value of the menu and return the name.
-      std::function<std::string()> get_fun =
-        [&var,menu](){
-          for (const MenuEntry<VAR_T> & entry : menu) {
-            if (var == entry.value) return entry.name;
-          }
-          return std::string("UNKNOWN");
-        };
-
-      // Build the "set" function: take the name of the menu option and update variable..
-      std::function<void(std::string)> set_fun =
-        [&var,name,menu](const std::string & entry_name){
-          for (const MenuEntry<VAR_T> & entry : menu) {
-            if (entry_name == entry.name) { var = entry.value; return; }
-          };
-          // AddError("Trying to set menu '", name, "' to '", entry_name, "'; does not exist.");
-        };
+      emp::vector<VAR_T> values;
+      emp::vector<std::string> names;
 
       // Update the description to list all of the menu options.
       std::stringstream new_desc;
@@ -164,10 +161,14 @@ namespace emplode {
       // Start with the input description and add the description for each menu option.
       new_desc << desc;
       for (const MenuEntry<VAR_T> & entry : menu) {
+        values.push_back(entry.value);
+        names.push_back(entry.name);
         new_desc << "\n " << entry.name << ": " << entry.desc;
       }
 
-      return AsScope().LinkFuns<std::string>(name, get_fun, set_fun, new_desc.str());
+      auto symbol = std::make_shared<Symbol_Menu<VAR_T>>(name, new_desc.str(), &AsScope(), var,
+                                                         std::move(values), std::move(names));
+      return AsScope().LinkSymbol(name, symbol);
     }
   };
 }
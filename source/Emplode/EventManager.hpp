@@ -19,12 +19,36 @@
  *  A event TRIGGER occurs to signify an event in a run (such as a new update or a
  *  collision); it specifies the signal that it is triggering and a set of associated
  *  data (to provide args to the actions)
+ *
+ *  An action may also have a SCHEDULE (from "EVERY p FROM a UNTIL b" or "AT t") so that it only
+ *  runs at particular times.  The time of a trigger is its first argument, if numeric, or else
+ *  the number of previous triggers of that signal.  Scheduled actions are kept in a queue
+ *  ordered by when they are next due, so a trigger only needs to look at actions that will
+ *  actually run.  Schedule expressions are evaluated at the first trigger after the action is
+ *  defined, allowing them to use variables set later in the configuration.
+ *
+ *  Actions with a higher PRIORITY run before those with a lower priority (default 0); actions
+ *  with equal priority run in the order they were defined.  An action may also have a GUARD
+ *  (from "WHEN (test)"), which is checked before any parameters are set; parameter variables
+ *  used in the guard read the trigger arguments directly.  Actions can be removed using the
+ *  handle returned when they were added.
+ *
+ *  A signal may be DEFERRED, in which case its triggers are not run immediately.  Instead the
+ *  argument values are copied into a reusable queue and all pending triggers are delivered in
+ *  batches when the host calls DeliverTriggers().  Within a batch, triggers are grouped by
+ *  signal (in the order signals were added) so that each set of actions is run back-to-back;
+ *  triggers for a single signal keep their relative order.  Triggers queued while a batch is
+ *  being delivered go into the next batch rather than being dispatched recursively.
  * 
  */
 
 #ifndef EMPLODE_EVENT_MANAGER_HPP
 #define EMPLODE_EVENT_MANAGER_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <string>
 
 #include "emp/base/map.hpp"
@@ -35,28 +59,149 @@
 
 namespace emplode {
 
+  /// Expressions describing when an event action should run; null entries are not used.
+  struct EventSchedule {
+    emp::Ptr<ASTNode> every = nullptr;  ///< Time between runs (EVERY); null for a single run.
+    emp::Ptr<ASTNode> from = nullptr;   ///< First time to run (FROM or AT); default 0.
+    emp::Ptr<ASTNode> until = nullptr;  ///< Last time that a run is allowed (UNTIL).
+    bool is_at = false;                 ///< Was this schedule given as "AT t"?
+
+    bool IsUsed() const { return from || every; }
+  };
+
   class EventManager {
   private:
     using symbol_ptr_t = emp::Ptr<Symbol>;
     using symbol_vec_t = emp::vector<symbol_ptr_t>;
     using node_ptr_t = emp::Ptr<ASTNode>;
     using node_vec_t = emp::vector< node_ptr_t >;
+    struct Action;
     struct Event;
 
     std::unordered_map<std::string, emp::Ptr<Event>> event_map;
+    emp::vector<emp::Ptr<Event>> events;     ///< All events, indexed by signal ID.
+    std::unordered_map<size_t, emp::Ptr<Action>> action_map;  ///< Actions by handle.
+    size_t next_handle = 1;                  ///< Handle to give the next action added.
     SymbolTableBase & symbol_table;
 
+    /// A deferred trigger; its argument values are stored in a shared buffer.
+    struct QueuedTrigger {
+      emp::Ptr<Event> event;
+      size_t arg_start;
+      size_t num_args;
+    };
+    /// Argument values for queued triggers; strings are stored separately, with their index
+    /// in place of the numerical value.
+    struct ArgBuffer {
+      emp::vector<double> values;
+      emp::vector<bool> is_string;
+      emp::vector<std::string> strings;
+
+      size_t size() const { return values.size(); }
+      void clear() { values.resize(0); is_string.resize(0); strings.resize(0); }
+    };
+    emp::vector<QueuedTrigger> trigger_queue;    ///< Triggers waiting for delivery.
+    ArgBuffer arg_queue;                         ///< Argument values for queued triggers.
+    emp::vector<QueuedTrigger> trigger_batch;    ///< Batch currently being delivered.
+    ArgBuffer arg_batch;                         ///< Argument values for the current batch.
+    emp::vector<size_t> batch_counts;            ///< Scratch space to group a batch by signal.
+    emp::vector<size_t> batch_order;             ///< Delivery order for the current batch.
+    emp::vector<emp::Ptr<Symbol_Var>> arg_vars;  ///< Reusable symbols for delivering arguments.
+    bool delivering = false;                     ///< Is a batch currently being delivered?
+
     struct Action {
       std::string signal_name;
       node_vec_t params;
       node_ptr_t action;
       size_t def_line;
-
-      Action(const std::string & _signal, node_vec_t _params, node_ptr_t _action, size_t _line)
-      : signal_name(_signal), params(_params), action(_action), def_line(_line) { }
+      size_t id;                   ///< Position of this action in its event (definition order)
+      size_t handle;               ///< Unique ID used to remove this action.
+      EventSchedule schedule;      ///< When should this action run? (unused for every trigger)
+      double priority = 0.0;       ///< Actions with higher priority run first.
+      node_ptr_t guard = nullptr;  ///< Test on trigger arguments to decide if action should run.
+      emp::Ptr<const symbol_vec_t> guard_args = nullptr;  ///< Arguments while guard is tested.
+      bool removed = false;        ///< Has this action been removed (pending cleanup)?
+
+      // Schedule values, set once the schedule has been evaluated.
+      double next_time = 0.0;      ///< When is this action next due?
+      double period = 0.0;         ///< Time between runs (0 = run only once)
+      double end_time = std::numeric_limits<double>::infinity();  ///< Last allowed run time
+
+      Action(const std::string & _signal, node_vec_t _params, node_ptr_t _action, size_t _line,
+             size_t _id, size_t _handle, EventSchedule _schedule, double _priority, node_ptr_t _guard)
+      : signal_name(_signal), params(_params), action(_action), def_line(_line), id(_id)
+      , handle(_handle), schedule(_schedule), priority(_priority)
+      {
+        if (_guard) guard = BindGuardArgs(_guard);
+      }
       ~Action() {
         for (auto x : params) x.Delete();
         action.Delete();
+        for (node_ptr_t node : {schedule.every, schedule.from, schedule.until, guard}) {
+          if (node) node.Delete();
+        }
+      }
+
+      /// Replace parameter variables in a guard with direct reads of the trigger arguments.
+      node_ptr_t BindGuardArgs(node_ptr_t node) {
+        if (auto var_node = node.DynamicCast<ASTNode_Var>()) {
+          for (size_t param_id = 0; param_id < params.size(); ++param_id) {
+            auto param_node = params[param_id].DynamicCast<ASTNode_Var>();
+            if (!param_node || !var_node->RefersTo(*param_node)) continue;
+            auto arg_node = emp::NewPtr<ASTNode_TriggerArg>(guard_args, param_id,
+                                                            var_node->GetName(), var_node->GetLine());
+            arg_node->SetParent(node->GetParent());
+            node.Delete();
+            return arg_node;
+          }
+          return node;
+        }
+
+        for (size_t child_id = 0; child_id < node->GetNumChildren(); ++child_id) {
+          node_ptr_t child = node->GetChild(child_id);
+          node_ptr_t new_child = BindGuardArgs(child);
+          if (new_child != child) node.DynamicCast<ASTNode_Internal>()->SetChild(child_id, new_child);
+        }
+        return node;
+      }
+
+      /// Should this action run before another one?
+      bool RunsBefore(const Action & other) const {
+        return priority > other.priority || (priority == other.priority && id < other.id);
+      }
+
+      bool IsScheduled() const { return schedule.IsUsed(); }
+
+      double EvalScheduleValue(node_ptr_t node, const std::string & keyword) {
+        Value result = node->Process();
+        if (!result || !result->IsNumeric()) {
+          std::cerr << "ERROR (line " << def_line << "): " << keyword << " value for signal '"
+                    << signal_name << "' must be numeric." << std::endl;
+          exit(1);
+        }
+        return result->AsDouble();
+      }
+
+      /// Evaluate the schedule expressions; return whether the action will ever run.
+      bool StartSchedule() {
+        if (schedule.from) next_time = EvalScheduleValue(schedule.from, schedule.is_at ? "AT" : "FROM");
+        if (schedule.until) end_time = EvalScheduleValue(schedule.until, "UNTIL");
+        if (schedule.every) {
+          period = EvalScheduleValue(schedule.every, "EVERY");
+          if (period <= 0.0) {
+            std::cerr << "ERROR (line " << def_line << "): EVERY value for signal '"
+                      << signal_name << "' must be positive." << std::endl;
+            exit(1);
+          }
+        }
+        return next_time <= end_time;
+      }
+
+      /// Move to the first run time after cur_time; return whether the action will run again.
+      bool AdvanceSchedule(double cur_time) {
+        if (period == 0.0) return false;
+        next_time += period * (std::floor((cur_time - next_time) / period) + 1.0);
+        return next_time <= end_time;
       }
 
       void Trigger(const symbol_vec_t & args) {
@@ -68,11 +213,20 @@ namespace emplode {
           exit(1);
         }
 
+        // Test the guard before spending any time setting up parameters.  The guard only
+        // borrows the arguments (see ASTNode_TriggerArg), so the caller still owns them.
+        if (guard) {
+          guard_args = &args;
+          const bool pass = guard->ProcessAs<double>() != 0.0;
+          guard_args = nullptr;
+          if (!pass) return;
+        }
+
         // Setup all of the parameters.
         for (size_t param_id = 0; param_id < params.size(); ++param_id) {
-          symbol_ptr_t param_sym = params[param_id]->Process();
+          Value param_sym = params[param_id]->Process();
 
-          if (param_sym->IsTemporary()) {
+          if (param_sym.IsOwned()) {
             std::cerr << "ERROR (line " << def_line << "): parameter " << param_id
                       << " is invalid; not a proper lvalue." << std::endl;
             exit(1);
@@ -87,14 +241,21 @@ namespace emplode {
         }
 
         // Once all of the parameter values are in place, run the action!
-        symbol_ptr_t result = action->Process();
-        if (result && result->IsTemporary()) result.Delete();
+        action->ProcessVoid();
       }
 
       void Write(std::ostream & os) const {
         os << "@" << signal_name << "(";
         // @CAO: Write out parameters...      
         os << ") ";
+        if (priority != 0.0) os << "PRIORITY " << priority << " ";
+        if (schedule.is_at) { os << "AT "; schedule.from->Write(os); os << " "; }
+        else if (schedule.every) {
+          os << "EVERY "; schedule.every->Write(os); os << " ";
+          if (schedule.from) { os << "FROM "; schedule.from->Write(os); os << " "; }
+          if (schedule.until) { os << "UNTIL "; schedule.until->Write(os); os << " "; }
+        }
+        if (guard) { os << "WHEN ("; guard->Write(os); os << ") "; }
         action->Write(os);
         os << ";\n";
       }
@@ -102,17 +263,123 @@ namespace emplode {
 
     struct Event {
       std::string signal_name;
-      size_t num_params;
-      emp::vector<emp::Ptr<Action>> actions;
+      int num_params;          ///< Arguments expected by TRIGGER (-1 = any number)
+      size_t id;               ///< Position of this signal in the events vector.
+      bool deferred = false;   ///< Should triggers be queued until DeliverTriggers()?
+      size_t step_limit = 0;   ///< Execution budget per action (0 = use symbol table default)
+      size_t num_triggers = 0; ///< Time to use for triggers without a numeric first argument
+      size_t next_action_id = 0;  ///< ID for the next action added (to track definition order).
+      size_t trigger_depth = 0;   ///< How many triggers of this event are currently running?
+      bool has_removed = false;   ///< Are there removed actions waiting to be cleaned up?
+      emp::vector<emp::Ptr<Action>> actions;     ///< All actions, in definition order.
+      emp::vector<emp::Ptr<Action>> unscheduled; ///< Actions to run on every trigger, in run order.
+      emp::vector<emp::Ptr<Action>> new_timed;   ///< Scheduled actions not yet evaluated.
+      emp::vector<emp::Ptr<Action>> timed_queue; ///< Heap of scheduled actions, soonest first.
+      emp::vector<emp::Ptr<Action>> due;         ///< Scratch space for actions due this trigger.
+
+      static bool LaterThan(emp::Ptr<Action> a1, emp::Ptr<Action> a2) {
+        return a1->next_time > a2->next_time || (a1->next_time == a2->next_time && a1->id > a2->id);
+      }
 
-      Event(const std::string & _name, size_t _params)
-        : signal_name(_name), num_params(_params) { }
+      Event(const std::string & _name, int _params, size_t _id)
+        : signal_name(_name), num_params(_params), id(_id) { }
       ~Event() { for (auto ptr : actions) ptr.Delete(); }
 
-      void Trigger(symbol_vec_t args) {
-        for (emp::Ptr<Action> action : actions) {
-          action->Trigger(args);
+      static bool RunsBefore(emp::Ptr<Action> a1, emp::Ptr<Action> a2) { return a1->RunsBefore(*a2); }
+
+      void AddAction(emp::Ptr<Action> action) {
+        actions.push_back(action);
+        if (action->IsScheduled()) new_timed.push_back(action);
+        else {
+          auto pos = std::upper_bound(unscheduled.begin(), unscheduled.end(), action, RunsBefore);
+          unscheduled.insert(pos, action);
+        }
+      }
+
+      /// Mark an action as removed; it is deleted once no triggers of this event are running.
+      void RemoveAction(emp::Ptr<Action> action) {
+        action->removed = true;
+        has_removed = true;
+        if (trigger_depth == 0) CleanupRemoved();
+      }
+
+      void CleanupRemoved() {
+        auto is_removed = [](emp::Ptr<Action> action){ return action->removed; };
+        std::erase_if(unscheduled, is_removed);
+        std::erase_if(new_timed, is_removed);
+        std::erase_if(timed_queue, is_removed);
+        std::make_heap(timed_queue.begin(), timed_queue.end(), LaterThan);
+        std::erase_if(actions, [](emp::Ptr<Action> action){
+          if (!action->removed) return false;
+          action.Delete();
+          return true;
+        });
+        has_removed = false;
+      }
+
+      void QueueAction(emp::Ptr<Action> action) {
+        timed_queue.push_back(action);
+        std::push_heap(timed_queue.begin(), timed_queue.end(), LaterThan);
+      }
+
+      void RunAction(emp::Ptr<Action> action, const symbol_vec_t & args, SymbolTableBase & symbol_table) {
+        if (action->removed) return;
+        symbol_table.BeginRun(step_limit);   // Each action gets its own execution budget.
+        action->Trigger(args);
+        symbol_table.EndRun();
+      }
+
+      void Trigger(const symbol_vec_t & args, SymbolTableBase & symbol_table) {
+        ++trigger_depth;
+        RunDueActions(args, symbol_table);
+        if (--trigger_depth == 0 && has_removed) CleanupRemoved();
+      }
+
+      void RunDueActions(const symbol_vec_t & args, SymbolTableBase & symbol_table) {
+        const double cur_time = (args.size() && args[0]->IsNumeric()) ?
+          args[0]->AsDouble() : static_cast<double>(num_triggers);
+        ++num_triggers;
+
+        // Evaluate the schedules of any newly added actions.
+        for (emp::Ptr<Action> action : new_timed) {
+          symbol_table.BeginRun(step_limit);
+          if (action->StartSchedule()) QueueAction(action);
+          symbol_table.EndRun();
+        }
+        new_timed.resize(0);
+
+        // Pull out all of the actions that are now due; usually this is only a single comparison.
+        // Actions may trigger this signal again, so only use the part of 'due' added here.
+        const size_t due_start = due.size();
+        while (timed_queue.size() && timed_queue.front()->next_time <= cur_time) {
+          std::pop_heap(timed_queue.begin(), timed_queue.end(), LaterThan);
+          due.push_back(timed_queue.back());
+          timed_queue.pop_back();
+        }
+
+        // Index-based loops are used below since actions may add new actions while running.
+        if (due.size() == due_start) {
+          for (size_t i = 0; i < unscheduled.size(); ++i) RunAction(unscheduled[i], args, symbol_table);
+          return;
+        }
+
+        // Run due actions interleaved with unscheduled ones, in priority order.
+        const size_t due_end = due.size();
+        std::sort(due.begin() + due_start, due.end(), RunsBefore);
+        size_t due_pos = due_start;
+        for (size_t i = 0; i < unscheduled.size(); ++i) {
+          while (due_pos < due_end && RunsBefore(due[due_pos], unscheduled[i])) {
+            RunAction(due[due_pos++], args, symbol_table);
+          }
+          RunAction(unscheduled[i], args, symbol_table);
         }
+        while (due_pos < due_end) RunAction(due[due_pos++], args, symbol_table);
+
+        // Schedule the next run of each action that went off.
+        for (size_t i = due_start; i < due_end; ++i) {
+          if (due[i]->AdvanceSchedule(cur_time)) QueueAction(due[i]);
+        }
+        due.resize(due_start);
       }
 
       void Write(std::ostream & os) const {
@@ -124,43 +391,120 @@ namespace emplode {
     };
 
   public:
-    EventManager(SymbolTableBase & _s_table) : symbol_table(_s_table) { ; }
+    EventManager(SymbolTableBase & _s_table) : symbol_table(_s_table) {
+      trigger_queue.reserve(1024);
+      arg_queue.values.reserve(1024);
+      arg_queue.is_string.reserve(1024);
+    }
     ~EventManager() {
+      Clear();
+      for (auto ptr : arg_vars) ptr.Delete();
+    }
+
+    /// Remove all signals and their actions (any queued triggers are dropped).
+    void Clear() {
       // Must delete all events in the queue.
       for (auto [name, ptr] : event_map) {
         ptr.Delete();
       }
+      event_map.clear();
+      events.resize(0);
+      action_map.clear();
+      trigger_queue.resize(0);
+      arg_queue.clear();
     }
 
     bool HasSignal(const std::string & signal_name) const {
       return emp::Has(event_map, signal_name);
     }
 
-    bool AddSignal(const std::string & signal_name, size_t num_params) {
+    bool AddSignal(const std::string & signal_name, int num_params) {
       // @CAO Needs to become a user-level error?
       emp_assert(!emp::Has(event_map, signal_name), "Signal reused!", signal_name);
 
-      event_map[signal_name] = emp::NewPtr<Event>(signal_name, num_params);
+      auto event_ptr = emp::NewPtr<Event>(signal_name, num_params, events.size());
+      event_map[signal_name] = event_ptr;
+      events.push_back(event_ptr);
+
+      return true;
+    }
 
+    /// Get the numerical ID of a signal, for faster triggering.
+    size_t GetSignalID(const std::string & signal_name) const {
+      emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
+      return event_map.find(signal_name)->second->id;
+    }
+
+    /// Number of arguments TRIGGER must provide for this signal (-1 = any number).
+    int GetNumParams(const std::string & signal_name) const {
+      emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
+      return event_map.find(signal_name)->second->num_params;
+    }
+
+    /// Should triggers of this signal be queued until DeliverTriggers() is called?
+    bool SetDeferred(const std::string & signal_name, bool deferred=true) {
+      emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
+      event_map[signal_name]->deferred = deferred;
       return true;
     }
 
-    /// Add a new event action
-    bool AddAction(
+    /// How many triggers are waiting to be delivered?
+    size_t GetNumQueued() const { return trigger_queue.size(); }
+
+    /// Limit how many steps each action of a signal may take before it is aborted.
+    bool SetStepLimit(const std::string & signal_name, size_t step_limit) {
+      emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
+      event_map[signal_name]->step_limit = step_limit;
+      return true;
+    }
+
+    /// Add a new event action; returns a handle that can be used to remove it.
+    size_t AddAction(
       const std::string & signal_name,  ///< Name of signal to trigger using
       node_vec_t params,                ///< Parameters to set before taking action
       node_ptr_t action,                ///< Abstract syntax tree to run when triggered
-      size_t def_line                   ///< What file line was this defined on?
+      size_t def_line,                  ///< What file line was this defined on?
+      EventSchedule schedule={},        ///< When should this action run? (default: always)
+      double priority=0.0,              ///< Actions with higher priority run first.
+      node_ptr_t guard=nullptr          ///< Test to run (on trigger args) before the action.
     ) {
       // @CAO Needs to become a user-level error?
       emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
 
-      auto action_ptr = emp::NewPtr<Action>(signal_name, params, action, def_line);
-      event_map[signal_name]->actions.push_back(action_ptr);
+      emp::Ptr<Event> event = event_map[signal_name];
+      const size_t handle = next_handle++;
+      auto action_ptr = emp::NewPtr<Action>(signal_name, params, action, def_line,
+                                            event->next_action_id++, handle, schedule,
+                                            priority, guard);
+      event->AddAction(action_ptr);
+      action_map[handle] = action_ptr;
+
+      return handle;
+    }
 
+    /// Remove the action with the provided handle; return false if there is no such action.
+    /// Actions removed while their signal is being triggered will not run again.
+    bool RemoveAction(size_t handle) {
+      auto it = action_map.find(handle);
+      if (it == action_map.end()) return false;
+      emp::Ptr<Action> action = it->second;
+      action_map.erase(it);
+      event_map[action->signal_name]->RemoveAction(action);
       return true;
     }
 
+    /// Get the handles for all actions linked to a signal, in the order that they will run.
+    emp::vector<size_t> GetActionHandles(const std::string & signal_name) const {
+      emp_assert(emp::Has(event_map, signal_name), "Unknown signal used!", signal_name);
+      emp::Ptr<Event> event = event_map.find(signal_name)->second;
+      emp::vector<emp::Ptr<Action>> ordered(event->actions);
+      std::erase_if(ordered, [](emp::Ptr<Action> action){ return action->removed; });
+      std::stable_sort(ordered.begin(), ordered.end(), Event::RunsBefore);
+      emp::vector<size_t> handles;
+      for (emp::Ptr<Action> action : ordered) handles.push_back(action->handle);
+      return handles;
+    }
+
     template <typename... ARG_TS>
     bool Trigger(const std::string & signal_name, ARG_TS... args) {
       // @CAO Make into user-level error.
@@ -168,7 +512,7 @@ namespace emplode {
 
       const std::string location = emp::to_string("trigger of ", signal_name);
       symbol_vec_t symbol_args = { symbol_table.ValueToSymbol(args, location)... };
-      event_map[signal_name]->Trigger(symbol_args);
+      TriggerSymbols(event_map[signal_name]->id, symbol_args);
 
       // Now that all of the actions have been run, clean up the symbol_args.
       for (auto symbol_ptr : symbol_args) {
@@ -178,9 +522,79 @@ namespace emplode {
       return true;
     }
 
+    /// Trigger a signal (by ID) using arguments that are already symbols.  If the signal is
+    /// deferred, the argument values are copied so the caller may delete them immediately.
+    void TriggerSymbols(size_t signal_id, const symbol_vec_t & args) {
+      emp_assert(signal_id < events.size(), signal_id, events.size());
+      emp::Ptr<Event> event = events[signal_id];
+      if (!event->deferred) {
+        event->Trigger(args, symbol_table);
+        return;
+      }
+
+      trigger_queue.push_back(QueuedTrigger{event, arg_queue.size(), args.size()});
+      for (symbol_ptr_t arg : args) {
+        if (arg->IsNumeric()) {
+          arg_queue.values.push_back(arg->AsDouble());
+          arg_queue.is_string.push_back(false);
+        }
+        else if (arg->IsString()) {
+          arg_queue.values.push_back(static_cast<double>(arg_queue.strings.size()));
+          arg_queue.is_string.push_back(true);
+          arg_queue.strings.push_back(arg->AsString());
+        }
+        else {
+          std::cerr << "ERROR: deferred trigger of signal '" << event->signal_name
+                    << "' can only pass numbers and strings as arguments." << std::endl;
+          exit(1);
+        }
+      }
+    }
+
+    /// Run the actions for all deferred triggers, continuing until none are left.
+    void DeliverTriggers() {
+      if (delivering) return;   // Triggers from running actions are handled by the outer loop.
+      delivering = true;
+
+      while (trigger_queue.size()) {
+        // Move the pending triggers into the current batch; new triggers will queue for the next.
+        std::swap(trigger_queue, trigger_batch);
+        std::swap(arg_queue, arg_batch);
+
+        // Group the batch by signal with a (stable) counting sort on signal ID.
+        batch_counts.assign(events.size() + 1, 0);
+        for (const QueuedTrigger & trigger : trigger_batch) ++batch_counts[trigger.event->id + 1];
+        for (size_t i = 1; i < batch_counts.size(); ++i) batch_counts[i] += batch_counts[i-1];
+        batch_order.resize(trigger_batch.size());
+        for (size_t i = 0; i < trigger_batch.size(); ++i) {
+          batch_order[batch_counts[trigger_batch[i].event->id]++] = i;
+        }
+
+        symbol_vec_t args;
+        for (size_t trigger_id : batch_order) {
+          const QueuedTrigger & trigger = trigger_batch[trigger_id];
+          while (arg_vars.size() < trigger.num_args) arg_vars.push_back(emp::NewPtr<Symbol_Var>(0.0));
+          args.resize(trigger.num_args);
+          for (size_t i = 0; i < trigger.num_args; ++i) {
+            const size_t arg_id = trigger.arg_start + i;
+            const double value = arg_batch.values[arg_id];
+            if (arg_batch.is_string[arg_id]) arg_vars[i]->SetString(arg_batch.strings[(size_t) value]);
+            else arg_vars[i]->SetValue(value);
+            args[i] = arg_vars[i];
+          }
+          trigger.event->Trigger(args, symbol_table);
+        }
+
+        trigger_batch.resize(0);
+        arg_batch.clear();
+      }
+
+      delivering = false;
+    }
+
     /// Print all of the events being tracked here.
     void Write(std::ostream & os) const {
-      for (auto [name, ptr] : event_map) {
+      for (emp::Ptr<Event> ptr : events) {
         ptr->Write(os);
       }
     }
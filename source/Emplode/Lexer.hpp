@@ -35,11 +35,12 @@ namespace emplode {
       token_keyword = AddToken("Keyword",
         "(ELSE)|(IF)"
         // Reserved keywords below.
-        "|(AND)|(AUTO)|(BREAK)|(CASE)|(CAST)|(CATCH)|(CLASS)|(CONST)|(CONTINUE)|(DEBUG)"
-        "|(DEFAULT)|(DEFINE)|(DELETE)|(DO)|(EVENT)|(EVERY)|(FALSE)|(FOR)|(FOREACH)"
-        "|(FUNCTION)|(GOTO)|(IN)|(INCLUDE)|(MUTABLE)|(NAMESPACE)|(NEW)|(OR)|(PRIVATE)"
-        "|(PROTECTED)|(PUBLIC)|(RETURN)|(SIGNAL)|(STATIC)|(SWITCH)|(TEMPLATE)|(THIS)"
-        "|(THROW)|(TRIGGER)|(TRUE)|(TRY)|(TYPE)|(UNION)|(USING)|(WHILE)|(YIELD)");
+        "|(AND)|(AT)|(AUTO)|(BREAK)|(CASE)|(CAST)|(CATCH)|(CLASS)|(CONST)|(CONTINUE)|(DEBUG)"
+        "|(DEFAULT)|(DEFINE)|(DELETE)|(DO)|(EVENT)|(EVERY)|(FALSE)|(FOR)|(FOREACH)|(FROM)"
+        "|(FUNCTION)|(GOTO)|(IN)|(INCLUDE)|(MUTABLE)|(NAMESPACE)|(NEW)|(OR)|(PRIORITY)"
+        "|(PRIVATE)|(PROTECTED)|(PUBLIC)|(PURE)|(RETURN)|(SIGNAL)|(STATIC)|(SWITCH)|(TEMPLATE)"
+        "|(THIS)|(THROW)|(TRIGGER)|(TRUE)|(TRY)|(TYPE)|(UNION)|(UNTIL)|(USING)|(WHEN)"
+        "|(WHILE)|(YIELD)");
 
       // Meaningful tokens have next priority.
       token_identifier = AddToken("Identifier", "[a-zA-Z_][a-zA-Z0-9_]*");
@@ -48,7 +49,7 @@ namespace emplode {
 
       /// Symbol tokens should have least priority.  They include any solitary character not listed
       /// above, or pre-specified multi-character groups.
-      token_symbol = AddToken("Symbol", ".|\"::\"|\"==\"|\"!=\"|\"<=\"|\">=\"|\"->\"|\"&&\"|\"||\"|\"<<\"|\">>\"|\"++\"|\"--\"|\"**\"");
+      token_symbol = AddToken("Symbol", ".|\"::\"|\"==\"|\"!=\"|\"<=\"|\">=\"|\"->\"|\"&&\"|\"||\"|\"<<\"|\">>\"|\"++\"|\"--\"|\"**\"|\"..\"");
     }
 
     bool IsKeyword(const emp::Token token) const noexcept { return token.id == token_keyword; }
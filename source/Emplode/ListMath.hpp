@@ -0,0 +1,326 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ListMath.hpp
+ *  @brief Elementwise (broadcasting) math over numeric lists and matrices.
+ *  @note Status: BETA
+ *
+ *  A math function given one or more lists is applied to each position in turn; all lists
+ *  must have the same length and any scalar arguments are reused at every position.  A list
+ *  of lists (a matrix) is processed one row at a time, so shapes can nest to any depth.
+ *  Lists line up at their outermost level: MATRIX + [10, 20] adds 10 to the first row and 20
+ *  to the second.
+ *
+ *  Values are gathered from the list into contiguous arrays and handed to a kernel that
+ *  processes whole arrays at once.  Kernels for the most common operations (arithmetic,
+ *  SQRT, ABS, MIN, MAX, CLAMP) are written with SSE2 or AVX intrinsics when the compiler
+ *  targets them; any other function is run through a plain loop.
+ */
+
+#ifndef EMPLODE_LIST_MATH_HPP
+#define EMPLODE_LIST_MATH_HPP
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "emp/base/assert.hpp"
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+#include "emp/meta/FunInfo.hpp"
+
+#include "Symbol.hpp"
+#include "Symbol_Scope.hpp"
+
+namespace emplode {
+namespace ListMath {
+
+  using symbol_ptr_t = emp::Ptr<Symbol>;
+  using symbol_vector_t = emp::vector<symbol_ptr_t>;
+
+  /// A kernel fills out[0..n) from one input array per function argument.
+  using kernel_t = std::function<void(const double * const * in, double * out, size_t n)>;
+
+  namespace simd {
+#if defined(__AVX__)
+    using vec_t = __m256d;
+    static constexpr size_t WIDTH = 4;
+    inline vec_t Load(const double * p) { return _mm256_loadu_pd(p); }
+    inline void Store(double * p, vec_t v) { _mm256_storeu_pd(p, v); }
+    inline vec_t Set(double x) { return _mm256_set1_pd(x); }
+    inline vec_t Add(vec_t a, vec_t b) { return _mm256_add_pd(a, b); }
+    inline vec_t Sub(vec_t a, vec_t b) { return _mm256_sub_pd(a, b); }
+    inline vec_t Mul(vec_t a, vec_t b) { return _mm256_mul_pd(a, b); }
+    inline vec_t Div(vec_t a, vec_t b) { return _mm256_div_pd(a, b); }
+    inline vec_t Sqrt(vec_t a) { return _mm256_sqrt_pd(a); }
+    inline vec_t Min(vec_t a, vec_t b) { return _mm256_min_pd(a, b); }
+    inline vec_t Max(vec_t a, vec_t b) { return _mm256_max_pd(a, b); }
+    inline vec_t AndNot(vec_t a, vec_t b) { return _mm256_andnot_pd(a, b); }
+    inline vec_t Less(vec_t a, vec_t b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    inline vec_t Select(vec_t mask, vec_t a, vec_t b) { return _mm256_blendv_pd(b, a, mask); }
+#elif defined(__SSE2__)
+    using vec_t = __m128d;
+    static constexpr size_t WIDTH = 2;
+    inline vec_t Load(const double * p) { return _mm_loadu_pd(p); }
+    inline void Store(double * p, vec_t v) { _mm_storeu_pd(p, v); }
+    inline vec_t Set(double x) { return _mm_set1_pd(x); }
+    inline vec_t Add(vec_t a, vec_t b) { return _mm_add_pd(a, b); }
+    inline vec_t Sub(vec_t a, vec_t b) { return _mm_sub_pd(a, b); }
+    inline vec_t Mul(vec_t a, vec_t b) { return _mm_mul_pd(a, b); }
+    inline vec_t Div(vec_t a, vec_t b) { return _mm_div_pd(a, b); }
+    inline vec_t Sqrt(vec_t a) { return _mm_sqrt_pd(a); }
+    inline vec_t Min(vec_t a, vec_t b) { return _mm_min_pd(a, b); }
+    inline vec_t Max(vec_t a, vec_t b) { return _mm_max_pd(a, b); }
+    inline vec_t AndNot(vec_t a, vec_t b) { return _mm_andnot_pd(a, b); }
+    inline vec_t Less(vec_t a, vec_t b) { return _mm_cmplt_pd(a, b); }
+    inline vec_t Select(vec_t mask, vec_t a, vec_t b) {
+      return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    }
+#else
+    static constexpr size_t WIDTH = 0;   // No vector unit; kernels use scalar loops only.
+#endif
+  }
+
+  // Each operation provides a scalar version and (when available) a vector version; the
+  // vector versions must give exactly the same results as the scalar builtins, including
+  // for NaN inputs (e.g. MIN returns its second argument when the comparison fails).
+  struct OpAdd {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return x + y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Add(x, y); }
+#endif
+  };
+
+  struct OpSub {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return x - y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Sub(x, y); }
+#endif
+  };
+
+  struct OpMul {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return x * y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Mul(x, y); }
+#endif
+  };
+
+  struct OpDiv {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return x / y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Div(x, y); }
+#endif
+  };
+
+  struct OpSqrt {
+    static constexpr size_t ARITY = 1;
+    static double Scalar(double x) { return std::sqrt(x); }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x) { return simd::Sqrt(x); }
+#endif
+  };
+
+  struct OpAbs {
+    static constexpr size_t ARITY = 1;
+    static double Scalar(double x) { return std::abs(x); }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x) { return simd::AndNot(simd::Set(-0.0), x); }
+#endif
+  };
+
+  struct OpMin {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return (x<y) ? x : y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Min(x, y); }
+#endif
+  };
+
+  struct OpMax {
+    static constexpr size_t ARITY = 2;
+    static double Scalar(double x, double y) { return (x>y) ? x : y; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y) { return simd::Max(x, y); }
+#endif
+  };
+
+  struct OpClamp {
+    static constexpr size_t ARITY = 3;
+    static double Scalar(double x, double y, double z) { return (x<y) ? y : (x>z) ? z : x; }
+#if defined(__AVX__) || defined(__SSE2__)
+    static simd::vec_t Vector(simd::vec_t x, simd::vec_t y, simd::vec_t z) {
+      simd::vec_t upper = simd::Select(simd::Less(z, x), z, x);
+      return simd::Select(simd::Less(x, y), y, upper);
+    }
+#endif
+  };
+
+  template <typename OP, size_t... IDS>
+  void RunKernel(const double * const * in, double * out, size_t n, std::index_sequence<IDS...>) {
+    size_t i = 0;
+#if defined(__AVX__) || defined(__SSE2__)
+    for (; i + simd::WIDTH <= n; i += simd::WIDTH) {
+      simd::Store(out + i, OP::Vector(simd::Load(in[IDS] + i)...));
+    }
+#endif
+    for (; i < n; ++i) out[i] = OP::Scalar(in[IDS][i]...);
+  }
+
+  /// Kernel for one of the operations above.
+  template <typename OP>
+  void Kernel(const double * const * in, double * out, size_t n) {
+    RunKernel<OP>(in, out, n, std::make_index_sequence<OP::ARITY>());
+  }
+
+  /// Build a (scalar-loop) kernel from any function that takes and returns numbers.
+  template <typename FUN_T>
+  kernel_t MakeKernel(FUN_T fun) {
+    constexpr size_t ARITY = emp::FunInfo<FUN_T>::num_args;
+    return [fun](const double * const * in, double * out, size_t n) {
+      [&]<size_t... IDS>(std::index_sequence<IDS...>) {
+        for (size_t i = 0; i < n; ++i) out[i] = static_cast<double>(fun(in[IDS][i]...));
+      }(std::make_index_sequence<ARITY>());
+    };
+  }
+
+  /// Numeric value of a list element or scalar argument; anything else is an error.
+  inline double ToNumber(const std::string & name, symbol_ptr_t value) {
+    if (!value->IsNumeric()) {
+      std::cerr << "Error in call to '" << name << "': list math requires numeric values; '"
+                << value->AsString() << "' is not a number." << std::endl;
+      exit(1);
+    }
+    return value->AsDouble();
+  }
+
+  /// Copy the values out of a numeric list into a contiguous array.
+  inline emp::vector<double> GatherValues(const std::string & name, symbol_ptr_t list) {
+    if (!list || !list->IsList()) {
+      std::cerr << "Error in call to '" << name << "': expected a list argument." << std::endl;
+      exit(1);
+    }
+    const auto & values = list.DynamicCast<Symbol_List>()->GetValues();
+    emp::vector<double> out(values.size());
+    for (size_t i = 0; i < values.size(); ++i) out[i] = ToNumber(name, values[i]);
+    return out;
+  }
+
+  /// Build a temporary list symbol holding the provided values.
+  inline symbol_ptr_t MakeList(const emp::vector<double> & values) {
+    auto out_list = emp::NewPtr<Symbol_List>();
+    for (double value : values) out_list->Push(emp::NewPtr<Symbol_Var>(value));
+    out_list->SetTemporary();
+    return out_list;
+  }
+
+  /// Does any argument need broadcasting?
+  inline bool HasList(const symbol_vector_t & args) {
+    for (symbol_ptr_t arg : args) if (arg && arg->IsList()) return true;
+    return false;
+  }
+
+  /// Apply a kernel across the provided arguments, returning a (non-temporary) result that
+  /// matches the shape of the list arguments.
+  inline symbol_ptr_t BroadcastImpl(const std::string & name, const symbol_vector_t & args,
+                                    const kernel_t & kernel) {
+    // Determine the common length and whether any elements are themselves lists.
+    size_t num_values = 1;
+    bool has_list = false;
+    bool has_nested = false;
+    for (symbol_ptr_t arg : args) {
+      if (!arg) {
+        std::cerr << "Error in call to '" << name << "': argument does not produce a value."
+                  << std::endl;
+        exit(1);
+      }
+      if (!arg->IsList()) continue;
+      const auto & values = arg.DynamicCast<Symbol_List>()->GetValues();
+      if (has_list && values.size() != num_values) {
+        std::cerr << "Error in call to '" << name << "': lists have different lengths ("
+                  << num_values << " vs. " << values.size() << ")." << std::endl;
+        exit(1);
+      }
+      num_values = values.size();
+      has_list = true;
+      for (symbol_ptr_t value : values) if (value->IsList()) has_nested = true;
+    }
+
+    // Nested lists are handled one row at a time.
+    if (has_nested) {
+      auto out_list = emp::NewPtr<Symbol_List>();
+      symbol_vector_t row_args(args.size());
+      for (size_t i = 0; i < num_values; ++i) {
+        for (size_t arg_id = 0; arg_id < args.size(); ++arg_id) {
+          row_args[arg_id] = args[arg_id]->IsList()
+            ? args[arg_id].DynamicCast<Symbol_List>()->GetValues()[i] : args[arg_id];
+        }
+        out_list->Push(BroadcastImpl(name, row_args, kernel));
+      }
+      return out_list;
+    }
+
+    // Gather every argument into a contiguous array, repeating scalars.
+    emp::vector<double> buffer(num_values * (args.size() + 1));
+    emp::vector<const double *> in_ptrs(args.size());
+    for (size_t arg_id = 0; arg_id < args.size(); ++arg_id) {
+      double * arg_values = buffer.data() + arg_id * num_values;
+      in_ptrs[arg_id] = arg_values;
+      if (args[arg_id]->IsList()) {
+        const auto & values = args[arg_id].DynamicCast<Symbol_List>()->GetValues();
+        for (size_t i = 0; i < num_values; ++i) arg_values[i] = ToNumber(name, values[i]);
+      } else {
+        const double value = ToNumber(name, args[arg_id]);
+        for (size_t i = 0; i < num_values; ++i) arg_values[i] = value;
+      }
+    }
+
+    double * out_values = buffer.data() + args.size() * num_values;
+    kernel(in_ptrs.data(), out_values, num_values);
+
+    if (!has_list) return emp::NewPtr<Symbol_Var>(out_values[0]);
+
+    auto out_list = emp::NewPtr<Symbol_List>();
+    for (size_t i = 0; i < num_values; ++i) out_list->Push(emp::NewPtr<Symbol_Var>(out_values[i]));
+    return out_list;
+  }
+
+  /// Apply a kernel elementwise; the result is a temporary symbol owned by the caller.
+  inline symbol_ptr_t Broadcast(const std::string & name, const symbol_vector_t & args,
+                                const kernel_t & kernel) {
+    symbol_ptr_t result = BroadcastImpl(name, args, kernel);
+    result->SetTemporary();
+    return result;
+  }
+
+  /// Wrap a unified-form builtin so that list arguments are broadcast through the kernel
+  /// and all-scalar calls go straight to the original function.
+  template <typename WRAPPED_T>
+  auto MakeBroadcasting(const std::string & name, size_t num_params,
+                        WRAPPED_T scalar_fun, kernel_t kernel) {
+    return [name, num_params, scalar_fun, kernel](const symbol_vector_t & args) -> symbol_ptr_t {
+      if (!HasList(args)) return scalar_fun(args);
+      if (args.size() != num_params) {
+        std::cerr << "Error in call to function '" << name << "'; expected " << num_params
+                  << " arguments, but received " << args.size() << "." << std::endl;
+        exit(1);
+      }
+      return Broadcast(name, args, kernel);
+    };
+  }
+
+}
+}
+
+#endif
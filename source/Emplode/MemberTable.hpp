@@ -0,0 +1,138 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  MemberTable.hpp
+ *  @brief Compile-time tables of member functions for EmplodeTypes.
+ *  @note Status: BETA
+ *
+ *  Rather than adding member functions one at a time (each wrapped in its own converting
+ *  std::function), a type's InitType() may declare them all in a static table and register it
+ *  in one call:
+ *
+ *    static void InitType(TypeInfo & info) {
+ *      static constexpr std::tuple members{
+ *        MemberFun<&MyType::GetSize>{"SIZE", "Return the number of entries."},
+ *        MemberFun<[](MyType & obj, double x) { return obj.Scale(x); }>{"SCALE", "Scale all entries."},
+ *      };
+ *      info.AddMembers(members);
+ *    }
+ *
+ *  Each entry names its function as a template argument (a member function pointer or a lambda
+ *  without captures whose first parameter is the object), so its signature is known at compile
+ *  time and a trampoline is generated for it: a plain function pointer that converts each
+ *  argument directly to its parameter type.  The number of parameters is recorded with the
+ *  function, so calls with the wrong number of arguments are rejected before the trampoline is
+ *  reached (at parse time, when the parser can see which object is being used).
+ *
+ *  Registration still copies each name and description into the type's MemberFunInfo, and each
+ *  object still links its members through a std::function (see EmplodeType::Setup()); that
+ *  wrapper holds only two pointers (the object and the table entry).
+ */
+
+#ifndef EMPLODE_MEMBER_TABLE_HPP
+#define EMPLODE_MEMBER_TABLE_HPP
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+
+#include "Symbol.hpp"
+#include "SymbolTableBase.hpp"
+
+namespace emplode {
+
+  /// One entry in a table of member functions; FUN is the function to call.
+  template <auto FUN>
+  struct MemberFun {
+    std::string_view name;
+    std::string_view desc;
+
+    constexpr MemberFun(std::string_view in_name, std::string_view in_desc)
+      : name(in_name), desc(in_desc) { }
+  };
+
+  /// Signature of a callable, with any object it is a member of as a first parameter.
+  template <typename T> struct MemberFunSig_impl;
+  template <typename R, typename C, typename... Ps>
+  struct MemberFunSig_impl<R (C::*)(Ps...)> { using method_t = R(C &, Ps...); using call_t = R(Ps...); };
+  template <typename R, typename C, typename... Ps>
+  struct MemberFunSig_impl<R (C::*)(Ps...) const> { using method_t = R(const C &, Ps...); using call_t = R(Ps...); };
+  template <typename R, typename... Ps>
+  struct MemberFunSig_impl<R (*)(Ps...)> { using call_t = R(Ps...); };
+
+  /// Signature for calling FUN on an object: RETURN_T(OBJECT_T &, PARAM_Ts...)
+  template <auto FUN, typename FUN_T = decltype(FUN)>
+  constexpr auto MemberCallSig_impl() {
+    if constexpr (std::is_member_function_pointer_v<FUN_T>) {
+      return std::type_identity<typename MemberFunSig_impl<FUN_T>::method_t>{};
+    } else if constexpr (std::is_pointer_v<FUN_T>) {
+      return std::type_identity<typename MemberFunSig_impl<FUN_T>::call_t>{};
+    } else {
+      return std::type_identity<typename MemberFunSig_impl<decltype(&FUN_T::operator())>::call_t>{};
+    }
+  }
+  template <auto FUN> using member_call_sig_t = typename decltype(MemberCallSig_impl<FUN>())::type;
+
+  /// Trampoline for calling FUN on an object with a vector of arguments (one per signature).
+  template <auto FUN, typename SIG_T = member_call_sig_t<FUN>>
+  struct MemberTrampoline;
+
+  template <auto FUN, typename RETURN_T, typename OBJECT_T, typename... PARAM_Ts>
+  struct MemberTrampoline<FUN, RETURN_T(OBJECT_T, PARAM_Ts...)> {
+    using symbol_ptr_t = emp::Ptr<Symbol>;
+    using symbol_vector_t = const emp::vector<symbol_ptr_t> &;
+    using object_t = std::remove_cvref_t<OBJECT_T>;
+    using return_t = RETURN_T;
+
+    static_assert(std::is_lvalue_reference_v<OBJECT_T>,
+                  "First parameter for member functions must be a reference to the object");
+    static_assert(std::is_base_of_v<EmplodeType, object_t>,
+                  "Member functions must take a reference to the associated EmplodeType");
+    static_assert(!std::is_void_v<RETURN_T>,
+                  "Currently Emplode functions must provide a return value.");
+
+    /// A single parameter of symbol_vector_t takes any number of arguments (-1).
+    static constexpr int NUM_PARAMS =
+      (sizeof...(PARAM_Ts) == 1 && (std::is_same_v<PARAM_Ts, symbol_vector_t> && ...))
+      ? -1 : static_cast<int>(sizeof...(PARAM_Ts));
+
+    /// Member functions are only attached to objects of their own type (see
+    /// EmplodeType::Setup), so no dynamic cast is needed unless the base is virtual.
+    static object_t & Target(EmplodeType & obj) {
+      emp_assert(emp::Ptr<EmplodeType>(&obj).DynamicCast<object_t>(),
+                 "Internal error: member function call on wrong object type!");
+      if constexpr (IsStaticObjectCast<object_t>()) return static_cast<object_t &>(obj);
+      else return dynamic_cast<object_t &>(obj);
+    }
+
+    template <size_t... IDS>
+    static symbol_ptr_t CallWith(object_t & target, symbol_vector_t args, SymbolTableBase & st,
+                                 std::index_sequence<IDS...>) {
+      static const std::string location("member function");
+      return st.ValueToSymbol(std::invoke(FUN, target, args[IDS]->template As<PARAM_Ts>()...),
+                              location);
+    }
+
+    /// Call FUN; the number of arguments must already have been checked against NUM_PARAMS.
+    static symbol_ptr_t Call(EmplodeType & obj, symbol_vector_t args, SymbolTableBase & st) {
+      if constexpr (NUM_PARAMS == -1) {
+        static const std::string location("member function");
+        return st.ValueToSymbol(std::invoke(FUN, Target(obj), args), location);
+      } else {
+        emp_assert(args.size() == NUM_PARAMS, args.size(), NUM_PARAMS);
+        return CallWith(Target(obj), args, st, std::index_sequence_for<PARAM_Ts...>{});
+      }
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  MemoCache.hpp
+ *  @brief Bounded cache of function results, keyed on argument values.
+ *  @note Status: BETA
+ *
+ *  A pure function (one whose result depends only on its arguments) may be given a MemoCache
+ *  so that repeated calls with the same arguments reuse earlier results.  Only calls whose
+ *  arguments are all numbers or strings are cached; others are run directly (and counted as
+ *  bypassed).  When full, the least recently used result is evicted.
+ *
+ *  Results are stored as copies, and each hit returns a fresh copy, so callers may keep or
+ *  modify what they are given.
+ */
+
+#ifndef EMPLODE_MEMO_CACHE_HPP
+#define EMPLODE_MEMO_CACHE_HPP
+
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+
+#include "Symbol.hpp"
+
+namespace emplode {
+
+  class MemoCache {
+  private:
+    struct Entry {
+      std::string key;
+      emp::Ptr<Symbol> result;       ///< Owned copy of the result (may be null).
+    };
+    using entry_list_t = std::list<Entry>;
+
+    size_t capacity;
+    entry_list_t entries;            ///< Most recently used first.
+    std::unordered_map<std::string_view, entry_list_t::iterator> entry_map;  ///< Keys are in entries.
+
+    size_t num_hits = 0;
+    size_t num_misses = 0;
+    size_t num_evictions = 0;
+    size_t num_bypassed = 0;         ///< Calls that could not be cached.
+
+    void Evict() {
+      emp_assert(entries.size());
+      Entry & entry = entries.back();
+      entry_map.erase(entry.key);
+      if (entry.result) entry.result.Delete();
+      entries.pop_back();
+      ++num_evictions;
+    }
+
+  public:
+    MemoCache(size_t _capacity) : capacity(_capacity) { emp_assert(capacity > 0); }
+    MemoCache(const MemoCache &) = delete;
+    MemoCache & operator=(const MemoCache &) = delete;
+    ~MemoCache() { Clear(); }
+
+    size_t GetCapacity() const { return capacity; }
+    size_t GetSize() const { return entries.size(); }
+    size_t GetNumHits() const { return num_hits; }
+    size_t GetNumMisses() const { return num_misses; }
+    size_t GetNumEvictions() const { return num_evictions; }
+    size_t GetNumBypassed() const { return num_bypassed; }
+
+    /// Change the number of results kept, evicting the oldest if needed.
+    void SetCapacity(size_t in) {
+      emp_assert(in > 0);
+      capacity = in;
+      while (entries.size() > capacity) Evict();
+    }
+
+    /// Remove all stored results (statistics are kept).
+    void Clear() {
+      for (Entry & entry : entries) if (entry.result) entry.result.Delete();
+      entries.clear();
+      entry_map.clear();
+    }
+
+    /// Build the key for a set of arguments; returns false if they cannot be cached.
+    static bool MakeKey(const emp::vector<emp::Ptr<Symbol>> & args, std::string & key) {
+      key.clear();
+      for (emp::Ptr<Symbol> arg : args) {
+        if (arg->IsNumeric()) {
+          const uint64_t bits = std::bit_cast<uint64_t>(arg->AsDouble());
+          key += 'N';
+          key.append(reinterpret_cast<const char *>(&bits), sizeof(bits));
+        }
+        else if (arg->IsString()) {
+          const std::string & str = arg->AsString();
+          ((key += 'S') += std::to_string(str.size())) += ':';
+          key += str;
+        }
+        else return false;
+      }
+      return true;
+    }
+
+    /// Note a call whose arguments could not be used as a key.
+    void AddBypass() { ++num_bypassed; }
+
+    /// Look up a result; on a hit, set out to a new temporary copy of it and return true.
+    bool Find(const std::string & key, emp::Ptr<Symbol> & out) {
+      auto it = entry_map.find(key);
+      if (it == entry_map.end()) { ++num_misses; return false; }
+      ++num_hits;
+      entries.splice(entries.begin(), entries, it->second);    // Now most recently used.
+      const Entry & entry = entries.front();
+      out = entry.result ? entry.result->Clone() : nullptr;
+      if (out) out->SetTemporary();
+      return true;
+    }
+
+    /// Keep a copy of a result for future calls with the same key (unless a recursive call
+    /// already did).
+    void Store(const std::string & key, emp::Ptr<const Symbol> result) {
+      if (entry_map.count(key)) return;
+      if (entries.size() >= capacity) Evict();
+      emp::Ptr<Symbol> copy = result ? result->Clone() : nullptr;
+      if (copy) copy->SetTemporary(false);
+      entries.push_front(Entry{key, copy});
+      entry_map[entries.front().key] = entries.begin();
+    }
+
+    void PrintStats(std::ostream & os=std::cout) const {
+      os << "hits=" << num_hits << " misses=" << num_misses << " evictions=" << num_evictions
+         << " bypassed=" << num_bypassed << " size=" << entries.size() << "/" << capacity
+         << std::endl;
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ObjectPool.hpp
+ *  @brief Chunked storage for EmplodeType objects with stable addresses.
+ *  @note Status: BETA
+ *
+ *  An ObjectPool allocates objects in fixed-size chunks (slabs) rather than one at a time.
+ *  Objects never move once created, so pointers to them remain valid until they are freed.
+ *  Freed slots are kept on an intrusive free list and reused by the next allocation, so
+ *  types with many short-lived instances can be created and destroyed cheaply.  Live objects
+ *  can be visited in storage order with ForEach().
+ *
+ *  Chunks are allocated aligned to their own (power-of-two) size, so the chunk that owns any
+ *  object can be found by masking its address; freeing is constant time.
+ */
+
+#ifndef EMPLODE_OBJECT_POOL_HPP
+#define EMPLODE_OBJECT_POOL_HPP
+
+#include <bit>
+#include <bitset>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+
+namespace emplode {
+
+  class EmplodeType;
+
+  /// Type-erased interface so that TypeInfo can manage a pool without knowing its object type.
+  class ObjectPoolBase {
+  public:
+    virtual ~ObjectPoolBase() { }
+
+    virtual emp::Ptr<EmplodeType> NewObject() = 0;          ///< Build a default object.
+    virtual void FreeObject(emp::Ptr<EmplodeType> obj) = 0; ///< Destroy an object from this pool.
+    virtual size_t GetSize() const = 0;                     ///< How many objects are live?
+  };
+
+  template <typename T, size_t CHUNK_SIZE=256>
+  class ObjectPool : public ObjectPoolBase {
+  private:
+    static_assert(CHUNK_SIZE > 0, "ObjectPool chunks must hold at least one object.");
+
+    /// Each slot holds either a live object or a link to the next free slot.
+    union Slot {
+      Slot * next_free;
+      alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Chunk {
+      Slot slots[CHUNK_SIZE];
+      std::bitset<CHUNK_SIZE> live;   ///< Which slots currently hold an object?
+    };
+
+    static constexpr size_t CHUNK_ALIGN = std::bit_ceil(sizeof(Chunk));
+
+    emp::vector<Chunk *> chunks;      ///< All chunks, in allocation order.
+    Slot * free_head = nullptr;       ///< Next slot to hand out.
+    size_t num_live = 0;              ///< Number of objects currently allocated.
+
+    static Chunk & ChunkOf(const T * obj) {
+      auto addr = reinterpret_cast<std::uintptr_t>(obj) & ~(CHUNK_ALIGN - 1);
+      return *reinterpret_cast<Chunk *>(addr);
+    }
+
+    static size_t SlotID(const Chunk & chunk, const T * obj) {
+      return static_cast<size_t>(reinterpret_cast<const Slot *>(obj) - chunk.slots);
+    }
+
+    /// Allocate a new chunk and thread all of its slots onto the free list.
+    void AddChunk() {
+      void * mem = ::operator new(CHUNK_ALIGN, std::align_val_t(CHUNK_ALIGN));
+      Chunk * chunk = new (mem) Chunk;
+      for (size_t i = CHUNK_SIZE; i > 0; --i) {
+        chunk->slots[i-1].next_free = free_head;
+        free_head = &chunk->slots[i-1];
+      }
+      chunks.push_back(chunk);
+    }
+
+  public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool & operator=(const ObjectPool &) = delete;
+
+    ~ObjectPool() {
+      // Destroy any objects still in use, then release the chunks.
+      ForEach([](T & obj){ obj.~T(); });
+      for (Chunk * chunk : chunks) {
+        chunk->~Chunk();
+        ::operator delete(chunk, std::align_val_t(CHUNK_ALIGN));
+      }
+    }
+
+    size_t GetSize() const override { return num_live; }
+    size_t GetCapacity() const { return chunks.size() * CHUNK_SIZE; }
+    size_t GetNumChunks() const { return chunks.size(); }
+
+    /// Construct a new object in the pool; its address is stable until Free() is called.
+    template <typename... ARG_Ts>
+    emp::Ptr<T> New(ARG_Ts &&... args) {
+      if (!free_head) AddChunk();
+      Slot * slot = free_head;
+      free_head = slot->next_free;
+
+      T * obj = new (slot->storage) T(std::forward<ARG_Ts>(args)...);
+      Chunk & chunk = ChunkOf(obj);
+      chunk.live.set(SlotID(chunk, obj));
+      ++num_live;
+      return obj;
+    }
+
+    /// Destroy an object and return its slot to the free list.
+    void Free(emp::Ptr<T> obj_ptr) {
+      T * obj = obj_ptr.Raw();
+      Chunk & chunk = ChunkOf(obj);
+      const size_t slot_id = SlotID(chunk, obj);
+      emp_assert(chunk.live.test(slot_id), "Freeing an object that is not live in this pool.");
+
+      obj->~T();
+      chunk.live.reset(slot_id);
+      Slot * slot = &chunk.slots[slot_id];
+      slot->next_free = free_head;
+      free_head = slot;
+      --num_live;
+    }
+
+    /// Does this pool hold the provided object?
+    bool Has(emp::Ptr<const T> obj_ptr) const {
+      const T * obj = obj_ptr.Raw();
+      for (const Chunk * chunk : chunks) {
+        if (obj >= reinterpret_cast<const T *>(chunk->slots) &&
+            obj < reinterpret_cast<const T *>(chunk->slots + CHUNK_SIZE)) {
+          return chunk->live.test(SlotID(*chunk, obj));
+        }
+      }
+      return false;
+    }
+
+    /// Call the provided function on each live object, in storage order.
+    template <typename FUN_T>
+    void ForEach(FUN_T && fun) {
+      for (Chunk * chunk : chunks) {
+        if (chunk->live.none()) continue;
+        for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+          if (chunk->live.test(i)) fun(*reinterpret_cast<T *>(chunk->slots[i].storage));
+        }
+      }
+    }
+
+    // Type-erased interface used by TypeInfo.
+    emp::Ptr<EmplodeType> NewObject() override {
+      if constexpr (std::is_default_constructible_v<T>) return New();
+      else {
+        emp_assert(false, "Pooled type cannot be default constructed.");
+        return nullptr;
+      }
+    }
+    void FreeObject(emp::Ptr<EmplodeType> obj) override {
+      emp::Ptr<T> typed_obj = obj.DynamicCast<T>();
+      emp_assert(typed_obj, "Object being freed does not belong to this pool's type.");
+      Free(typed_obj);
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,582 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Optimizer.hpp
+ *  @brief Passes that rewrite a parsed AST to run faster without changing its behavior.
+ *  @note Status: BETA
+ *
+ *  Common subexpression elimination (ShareSubexpressions):
+ *  A node is pure if evaluating it has no side effects and does not build a new object:
+ *  literals, variable reads, member and subscript reads, math operators, and calls to
+ *  built-in functions marked pure (see Symbol_Function::SetPure()).  Linked variables are
+ *  assumed to have side-effect-free getters.
+ *
+ *  Within a region of code that is entirely pure (a maximal pure subtree, or the arguments of a
+ *  call, which are all evaluated before the call runs), repeated subexpressions are wrapped in
+ *  ASTNode_Reuse nodes that share one cached result.  The first copy evaluated computes the
+ *  value and the rest reuse it until the region's epoch advances; an ASTNode_ReuseScope at the
+ *  top of the region advances it each time the region is run.  A group of expressions run
+ *  back to back (such as the columns of a DataFile) may instead share one region whose epoch
+ *  is advanced by the caller.  A region can only be re-entered from its root (a call or
+ *  trigger, after all of its arguments are evaluated); results replaced by the inner run are
+ *  kept alive for the outer one.
+ *
+ *  Loop-invariant code motion (HoistInvariants):
+ *  A pure subexpression in a loop that reads no variable assigned in the loop is cached the
+ *  first time it is evaluated and reused for the rest of that run of the loop.  Values are
+ *  computed lazily (rather than before the loop starts) so that an expression that is never
+ *  reached, or would fail, is never run.  Loops that call impure functions, trigger signals,
+ *  or assign to members or entries (which may be shared with other variables) are left alone.
+ *
+ *  Counting loops (UnboxCounter):
+ *  A FOR loop that steps a variable toward a bound keeps its count in a double (see
+ *  ASTNode_For) when the bound and step amount are pure.  The variable itself is only updated
+ *  during the loop if the loop body or bound may use it (including through an impure call).
+ *
+ *  Inlining (InlineCall):
+ *  A call to a small user-defined function whose body is a single RETURN expression (such as
+ *  Var sq(x) { RETURN x*x; }) sets the parameters and evaluates that expression directly,
+ *  skipping the function-call machinery.  Bodies that call other user-defined functions are not
+ *  inlined (which also rules out recursion).  If the function is reassigned (or memoized), the
+ *  call falls back to a normal call.
+ */
+
+#ifndef EMPLODE_OPTIMIZER_HPP
+#define EMPLODE_OPTIMIZER_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+
+#include "AST.hpp"
+#include "Symbol_Function.hpp"
+#include "Value.hpp"
+
+namespace emplode {
+
+  /// Evaluation counter shared by all of the cached values in a region.
+  struct ReuseRegion {
+    uint64_t epoch = 1;
+    size_t depth = 0;                         ///< Runs of the region in progress.
+
+    /// Results replaced while the region was re-entered (by a recursive call or trigger from
+    /// the region's root); the outer run may still be using them, so they are kept until the
+    /// next outermost run begins.
+    emp::vector<emp::Ptr<Symbol>> retired;
+
+    ReuseRegion() = default;
+    ReuseRegion(const ReuseRegion &) = delete;
+    ReuseRegion & operator=(const ReuseRegion &) = delete;
+    ~ReuseRegion() { ClearRetired(); }
+
+    void ClearRetired() {
+      for (emp::Ptr<Symbol> symbol : retired) symbol.Delete();
+      retired.clear();
+    }
+  };
+
+  /// One cached result, shared by all copies of a subexpression.
+  class ReuseSlot {
+  private:
+    uint64_t epoch = 0;                     ///< Region epoch when symbol was computed.
+    emp::Ptr<Symbol> symbol = nullptr;      ///< Cached result.
+    bool owned = false;                     ///< Should symbol be deleted when replaced?
+
+  public:
+    ReuseSlot() = default;
+    ReuseSlot(const ReuseSlot &) = delete;
+    ReuseSlot & operator=(const ReuseSlot &) = delete;
+    ~ReuseSlot() { if (owned) symbol.Delete(); }
+
+    bool IsCurrent(uint64_t in_epoch) const { return epoch == in_epoch; }
+    emp::Ptr<Symbol> GetSymbol() const { return symbol; }
+
+    /// Store a new result; temporaries are kept here (and handed out only as borrowed).
+    void Set(Value && value, ReuseRegion & region) {
+      if (owned) {
+        if (region.depth > 1) region.retired.push_back(symbol);   // Outer run may hold it.
+        else symbol.Delete();
+      }
+      symbol = value.Release();
+      owned = symbol && symbol->IsTemporary();
+      if (owned) symbol->SetTemporary(false);
+      epoch = region.epoch;
+    }
+  };
+
+  /// A copy of a repeated pure subexpression (its only child); copies share a slot.
+  class ASTNode_Reuse : public ASTNode_Internal {
+  private:
+    std::shared_ptr<ReuseRegion> region;
+    std::shared_ptr<ReuseSlot> slot;
+
+  public:
+    ASTNode_Reuse(node_ptr_t node, std::shared_ptr<ReuseRegion> _region,
+                  std::shared_ptr<ReuseSlot> _slot)
+      : region(_region), slot(_slot)
+    {
+      line_id = node->GetLine();
+      AddChild(node);
+    }
+
+    bool IsNumeric() const override { return children[0]->IsNumeric(); }
+    bool IsString() const override { return children[0]->IsString(); }
+    bool HasValue() const override { return true; }
+
+    bool AppendKey(std::string & key) const override { key += 'R'; return true; }
+
+    Value Process() override {
+      if (!slot->IsCurrent(region->epoch)) slot->Set(children[0]->Process(), *region);
+      return slot->GetSymbol();    // Never temporary, so only borrowed.
+    }
+
+    void Write(std::ostream & os, const std::string & offset) const override {
+      children[0]->Write(os, offset);
+    }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_Reuse" << std::endl;
+      children[0]->PrintAST(os, indent+2);
+    }
+  };
+
+  /// Top of a region with shared subexpressions; starts a new epoch each time it runs.
+  class ASTNode_ReuseScope : public ASTNode_Internal {
+  private:
+    std::shared_ptr<ReuseRegion> region;
+
+  public:
+    ASTNode_ReuseScope(node_ptr_t node, std::shared_ptr<ReuseRegion> _region)
+      : region(_region)
+    {
+      line_id = node->GetLine();
+      AddChild(node);
+    }
+
+    const std::string & GetName() const override { return children[0]->GetName(); }
+    bool IsNumeric() const override { return children[0]->IsNumeric(); }
+    bool IsString() const override { return children[0]->IsString(); }
+    bool HasValue() const override { return children[0]->HasValue(); }
+
+    bool AppendKey(std::string & key) const override { key += "RS"; return true; }
+
+    Value Process() override {
+      if (region->depth == 0) region->ClearRetired();
+      ++region->epoch;
+      ++region->depth;
+      Value result = children[0]->Process();
+      --region->depth;
+      return result;
+    }
+
+    void Write(std::ostream & os, const std::string & offset) const override {
+      children[0]->Write(os, offset);
+    }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_ReuseScope" << std::endl;
+      children[0]->PrintAST(os, indent+2);
+    }
+  };
+
+  /// A call to a user-defined function with the function body inlined.  As with any call, the
+  /// children are the function followed by the arguments (so optimizations that apply to the
+  /// arguments of a call, such as sharing subexpressions, apply here too).
+  class ASTNode_Inline : public ASTNode_Call {
+  public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+  private:
+    Var fun_var;                      ///< Variable holding the function.
+    uint64_t def_id;                  ///< Function definition that was inlined.
+    emp::vector<Var> params;
+    emp::Ptr<ASTNode_Block> body;     ///< Full body of the function (not owned).
+    node_ptr_t expression;            ///< Expression returned by the body (not owned).
+
+  public:
+    /// Takes over the function and argument nodes of call, which is left empty.
+    ASTNode_Inline(emp::Ptr<ASTNode_Call> call, const Var & _fun_var, const Symbol_UserFunction & fun,
+                   node_ptr_t _expression)
+      : ASTNode_Call(call->TakeChildren(), call->GetLine())
+      , fun_var(_fun_var), def_id(fun.GetDefID()), params(fun.GetParams())
+      , body(fun.GetBody()), expression(_expression)
+    {
+      emp_assert(params.size() <= MAX_PARAMS);
+      emp_assert(children.size() == params.size() + 1);
+    }
+
+    Value Process() override {
+      // If the function has been redefined (or memoized), make a normal call.
+      emp::Ptr<Symbol_Function> fun = fun_var.GetValue()->AsFunctionPtr();
+      if (!fun || fun->GetDefID() != def_id || fun->HasMemo()) [[unlikely]] {
+        return ASTNode_Call::Process();
+      }
+
+      // Evaluate all arguments before setting any parameters (arguments may use them).
+      std::array<Value, MAX_PARAMS> args;
+      for (size_t i = 0; i < params.size(); ++i) args[i] = children[i+1]->Process();
+
+      SymbolTableBase & symbol_table = body->GetSymbolTable();
+      if (!symbol_table.UseStep()) [[unlikely]] {
+        symbol_table.BudgetExceeded(body->GetLine(), "function call");
+      }
+      for (size_t i = 0; i < params.size(); ++i) params[i].SetValue(args[i].Detach());
+
+      // As with a normal call, never return a (local) variable itself.
+      Value result = expression->Process();
+      if (!result || result.IsOwned()) return result;
+      emp::Ptr<Symbol> out = result.Detach();
+      out->SetTemporary();
+      return out;
+    }
+
+    void PrintAST(std::ostream & os=std::cout, size_t indent=0) override {
+      for (size_t i = 0; i < indent; ++i) os << " ";
+      os << "ASTNode_Inline" << std::endl;
+      for (auto child : children) child->PrintAST(os, indent+2);
+    }
+  };
+
+  class Optimizer {
+  private:
+    using node_ptr_t = emp::Ptr<ASTNode>;
+    using node_vector_t = emp::vector<node_ptr_t>;
+
+    struct NodeInfo {
+      bool pure = false;
+      std::string key;          ///< Identifies equivalent pure subtrees (empty if impure).
+    };
+
+    /// Location of a node: a child of parent, or (if parent is null) an entry in roots.
+    struct Use {
+      node_ptr_t parent;
+      size_t id;
+    };
+
+    /// What may change while a loop runs.
+    struct LoopWrites {
+      std::unordered_set<std::string> vars;   ///< Keys of variables assigned in the loop.
+      bool all = false;                       ///< Might anything else change?
+    };
+
+    bool enabled = true;
+    size_t inline_limit = 24;   ///< Max nodes in an expression to inline (0 = never inline).
+    size_t num_shared = 0;      ///< Copies of subexpressions now using a shared result.
+    size_t num_hoisted = 0;     ///< Loop-invariant subexpressions now cached across iterations.
+    size_t num_inlined = 0;     ///< Calls now running the function body directly.
+    size_t num_unboxed = 0;     ///< FOR loops now counting in a double.
+    std::unordered_map<const ASTNode *, NodeInfo> info;
+
+    /// Determine (and record) purity and keys for a full subtree.
+    const NodeInfo & Analyze(node_ptr_t node) {
+      NodeInfo out;
+      out.pure = node->AppendKey(out.key);
+      out.key += '(';
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        const NodeInfo & child_info = Analyze(node->GetChild(i));
+        if (node->IsLValueChild(i)) out.pure = false;   // Not evaluated as a value.
+        out.pure = out.pure && child_info.pure;
+        if (out.pure) (out.key += child_info.key) += ',';
+      }
+      out.key += ')';
+      if (!out.pure) out.key.clear();
+      return info[node.Raw()] = std::move(out);
+    }
+
+    bool IsPure(node_ptr_t node) const { return info.at(node.Raw()).pure; }
+
+    /// Are all children of this node evaluated as pure values?
+    bool HasPureChildren(node_ptr_t node) const {
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        if (node->IsLValueChild(i) || !IsPure(node->GetChild(i))) return false;
+      }
+      return true;
+    }
+
+    using count_map_t = std::unordered_map<std::string, size_t>;
+    using use_map_t = std::unordered_map<std::string, emp::vector<Use>>;
+
+    /// Count how often each (non-leaf) subexpression appears.
+    void CountKeys(node_ptr_t node, count_map_t & counts) const {
+      if (!node->IsLeaf()) ++counts[info.at(node.Raw()).key];
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) CountKeys(node->GetChild(i), counts);
+    }
+
+    /// Record the places that repeated subexpressions are used.  Only the first copy of a
+    /// repeated subexpression is searched further, since the others will never be evaluated.
+    void CollectUses(node_ptr_t parent, size_t id, node_ptr_t node,
+                     const count_map_t & counts, use_map_t & uses) const {
+      if (!node->IsLeaf()) {
+        const std::string & key = info.at(node.Raw()).key;
+        if (counts.at(key) > 1) {
+          auto & use_list = uses[key];
+          use_list.push_back(Use{parent, id});
+          if (use_list.size() > 1) return;
+        }
+      }
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        CollectUses(node, i, node->GetChild(i), counts, uses);
+      }
+    }
+
+    /// Wrap all repeated subexpressions; returns whether anything was shared.
+    bool ShareUses(use_map_t & uses,
+                   node_vector_t & roots, std::shared_ptr<ReuseRegion> region) {
+      bool shared = false;
+      for (auto & [key, use_list] : uses) {
+        if (use_list.size() < 2) continue;
+        auto slot = std::make_shared<ReuseSlot>();
+        for (const Use & use : use_list) {
+          if (use.parent) {
+            node_ptr_t node = use.parent->GetChild(use.id);
+            use.parent->SetChild(use.id, emp::NewPtr<ASTNode_Reuse>(node, region, slot));
+          } else {
+            roots[use.id] = emp::NewPtr<ASTNode_Reuse>(roots[use.id], region, slot);
+          }
+        }
+        num_shared += use_list.size();
+        shared = true;
+      }
+      return shared;
+    }
+
+    /// Share subexpressions within a single region; returns the (possibly new) region root.
+    node_ptr_t ShareRegion(node_ptr_t root) {
+      count_map_t counts;
+      use_map_t uses;
+      if (IsPure(root)) {
+        CountKeys(root, counts);
+        CollectUses(nullptr, 0, root, counts, uses);
+      }
+      else {
+        for (size_t i = 0; i < root->GetNumChildren(); ++i) CountKeys(root->GetChild(i), counts);
+        for (size_t i = 0; i < root->GetNumChildren(); ++i) {
+          CollectUses(root, i, root->GetChild(i), counts, uses);
+        }
+      }
+
+      node_vector_t roots{root};
+      auto region = std::make_shared<ReuseRegion>();
+      if (!ShareUses(uses, roots, region)) return root;
+      return emp::NewPtr<ASTNode_ReuseScope>(roots[0], region);
+    }
+
+    /// Find the regions in a tree and share within each.
+    node_ptr_t ShareInTree(node_ptr_t node) {
+      if (IsPure(node)) return node->IsLeaf() ? node : ShareRegion(node);
+      if (node->RunsAfterChildren() && HasPureChildren(node)) return ShareRegion(node);
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        node_ptr_t child = node->GetChild(i);
+        node_ptr_t new_child = ShareInTree(child);
+        if (new_child != child) node->SetChild(i, new_child);
+      }
+      return node;
+    }
+
+    /// Find everything that a loop may change.
+    void ScanWrites(node_ptr_t node, LoopWrites & writes) const {
+      if (writes.all || IsPure(node)) return;
+      std::string tag;
+      if ((node->RunsAfterChildren() && !node->AppendKey(tag))    // Impure call or trigger.
+          || node.DynamicCast<ASTNode_Event>() || node.DynamicCast<ASTNode_CopyFields>()
+          || node.DynamicCast<ASTNode_ClassInit>() || node.DynamicCast<ASTNode_StructInit>()) {
+        writes.all = true;
+        return;
+      }
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        node_ptr_t child = node->GetChild(i);
+        if (!node->IsLValueChild(i)) { ScanWrites(child, writes); continue; }
+        tag.clear();
+        if (child->IsLeaf() && child->AppendKey(tag) && tag[0] == 'V') writes.vars.insert(tag);
+        else writes.all = true;     // Members and entries may be shared by other variables.
+      }
+    }
+
+    /// Does a pure subtree read only variables that the loop leaves unchanged?
+    bool IsInvariant(node_ptr_t node, const LoopWrites & writes) const {
+      if (node->IsLeaf()) {
+        std::string tag;
+        node->AppendKey(tag);
+        return !writes.vars.count(tag);
+      }
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        if (!IsInvariant(node->GetChild(i), writes)) return false;
+      }
+      return true;
+    }
+
+    /// Cache the largest loop-invariant subexpressions below node.
+    void HoistInTree(node_ptr_t node, const LoopWrites & writes,
+                     std::shared_ptr<ReuseRegion> region,
+                     std::unordered_map<std::string, std::shared_ptr<ReuseSlot>> & slots) {
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        if (node->IsLValueChild(i)) continue;
+        node_ptr_t child = node->GetChild(i);
+        if (!child->IsLeaf() && IsPure(child) && IsInvariant(child, writes)) {
+          auto & slot = slots[info.at(child.Raw()).key];    // Identical copies share a slot.
+          if (!slot) slot = std::make_shared<ReuseSlot>();
+          node->SetChild(i, emp::NewPtr<ASTNode_Reuse>(child, region, slot));
+          ++num_hoisted;
+        }
+        else HoistInTree(child, writes, region, slots);
+      }
+    }
+
+    /// Does a subtree use the variable with the given key?
+    static bool Mentions(node_ptr_t node, const std::string & key) {
+      std::string tag;
+      if (node->IsLeaf() && node->AppendKey(tag) && tag == key) return true;
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        if (Mentions(node->GetChild(i), key)) return true;
+      }
+      return false;
+    }
+
+    /// Count the nodes in an expression that may be inlined; returns 0 if it calls any
+    /// user-defined function.
+    static size_t InlineSize(node_ptr_t node) {
+      if (auto var = node.DynamicCast<ASTNode_Var>()) {
+        const Symbol & symbol = var->GetSymbol();
+        if (!var->GetVar().IsLinked() && symbol.IsFunction() && !symbol.IsBuiltin()) return 0;
+      }
+      size_t size = 1;
+      for (size_t i = 0; i < node->GetNumChildren(); ++i) {
+        const size_t child_size = InlineSize(node->GetChild(i));
+        if (child_size == 0) return 0;
+        size += child_size;
+      }
+      return size;
+    }
+
+  public:
+    bool IsEnabled() const { return enabled; }
+    void SetEnabled(bool in=true) { enabled = in; }
+
+    size_t GetNumShared() const { return num_shared; }
+    size_t GetNumHoisted() const { return num_hoisted; }
+    size_t GetNumInlined() const { return num_inlined; }
+    size_t GetNumUnboxed() const { return num_unboxed; }
+
+    size_t GetInlineLimit() const { return inline_limit; }
+    void SetInlineLimit(size_t in) { inline_limit = in; }
+
+    /// Share repeated pure subexpressions within a statement; returns the new statement root.
+    node_ptr_t ShareSubexpressions(node_ptr_t root) {
+      if (!enabled || !root) return root;
+      Analyze(root);
+      root = ShareInTree(root);
+      info.clear();
+      return root;
+    }
+
+    /// Share repeated pure subexpressions across a group of expressions that are always run
+    /// together and in order; the caller must advance the region's epoch before each run.
+    /// If any expression is impure, each is handled on its own; returns whether the group
+    /// shares the region.
+    bool ShareSubexpressions(node_vector_t & roots, std::shared_ptr<ReuseRegion> region) {
+      if (!enabled) return false;
+      bool all_pure = true;
+      for (node_ptr_t root : roots) all_pure = Analyze(root).pure && all_pure;
+
+      if (all_pure) {
+        count_map_t counts;
+        use_map_t uses;
+        for (node_ptr_t root : roots) CountKeys(root, counts);
+        for (size_t i = 0; i < roots.size(); ++i) CollectUses(nullptr, i, roots[i], counts, uses);
+        ShareUses(uses, roots, region);
+      }
+      else {
+        for (node_ptr_t & root : roots) root = ShareInTree(root);
+      }
+
+      info.clear();
+      return all_pure;
+    }
+
+    /// Inline a call to a small user-defined function; returns the new node for the call.
+    node_ptr_t InlineCall(emp::Ptr<ASTNode_Call> call) {
+      if (!enabled || inline_limit == 0) return call;
+      auto fun_node = call->GetChild(0).DynamicCast<ASTNode_Var>();
+      if (!fun_node || fun_node->GetVar().IsLinked()) return call;
+      auto fun = emp::Ptr<Symbol>(&fun_node->GetSymbol()).DynamicCast<Symbol_UserFunction>();
+      if (!fun || !fun->HasOwnBody() || fun->HasMemo()) return call;
+
+      // Arguments must match parameters (otherwise the call reports the error).
+      const size_t num_params = fun->GetParams().size();
+      if (num_params > ASTNode_Inline::MAX_PARAMS) return call;
+      if (call->GetNumChildren() != num_params + 1) return call;
+
+      // The body must be a single RETURN of a small expression.
+      emp::Ptr<ASTNode_Block> body = fun->GetBody();
+      if (body->GetNumChildren() != 1) return call;
+      auto return_node = body->GetChild(0).DynamicCast<ASTNode_Return>();
+      if (!return_node || return_node->GetNumChildren() != 1) return call;
+      node_ptr_t expression = return_node->GetChild(0);
+      const size_t size = InlineSize(expression);
+      if (size == 0 || size > inline_limit) return call;
+
+      ++num_inlined;
+      auto out = emp::NewPtr<ASTNode_Inline>(call, fun_node->GetVar(), *fun, expression);
+      call.Delete();
+      return out;
+    }
+
+    /// Let a counting FOR loop keep its variable in a double, updating the variable during the
+    /// loop only if something in the loop may use it.
+    void UnboxCounter(emp::Ptr<ASTNode_For> loop) {
+      if (!enabled || !loop->GetCounter()) return;
+      Analyze(loop);
+      std::string key;
+      loop->GetCounter()->AppendKey(key);
+      bool observed = Mentions(loop->GetBody(), key);
+
+      // The limit and step amount may be evaluated again if the loop stops counting.
+      if (!loop->IsRange()) {
+        node_ptr_t limit = loop->GetLimit();
+        node_ptr_t amount = loop->GetStepAmount();
+        if (!IsPure(limit) || !IsPure(amount)) { info.clear(); return; }
+        observed = observed || Mentions(limit, key) || Mentions(amount, key);
+      }
+
+      LoopWrites writes;
+      ScanWrites(loop->GetBody(), writes);
+      loop->SetCounting(observed || writes.all);
+      ++num_unboxed;
+      info.clear();
+    }
+
+    /// Cache loop-invariant subexpressions for each run of a loop; every child of the loop
+    /// node is assumed to run on each iteration.  Returns the new root for the loop.
+    node_ptr_t HoistInvariants(node_ptr_t loop) {
+      if (!enabled || !loop) return loop;
+      Analyze(loop);
+      LoopWrites writes;
+      ScanWrites(loop, writes);
+
+      node_ptr_t out = loop;
+      const size_t prev_hoisted = num_hoisted;
+      if (!writes.all) {
+        auto region = std::make_shared<ReuseRegion>();
+        std::unordered_map<std::string, std::shared_ptr<ReuseSlot>> slots;
+        HoistInTree(loop, writes, region, slots);
+        if (num_hoisted > prev_hoisted) out = emp::NewPtr<ASTNode_ReuseScope>(loop, region);
+      }
+
+      info.clear();
+      return out;
+    }
+  };
+
+}
+
+#endif
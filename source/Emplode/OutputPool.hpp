@@ -0,0 +1,178 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  OutputPool.hpp
+ *  @brief Buffered output to many files while keeping only a few descriptors open.
+ *  @note Status: BETA
+ *
+ *  Text written to a file is collected in a per-file buffer and only handed to the operating
+ *  system once the buffer fills (or on Flush()).  At most max_open files are open at a time;
+ *  when another is needed, the least-recently flushed one is closed, and it is reopened in
+ *  append mode the next time it has data.  Each file is truncated the first time it is opened
+ *  during a run.
+ *
+ *  Errors in scripts end the program with exit(), which skips the destructors of local pools,
+ *  so every live pool is also flushed by a handler registered with std::atexit().
+ */
+
+#ifndef EMPLODE_OUTPUT_POOL_HPP
+#define EMPLODE_OUTPUT_POOL_HPP
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "emp/base/assert.hpp"
+
+namespace emplode {
+
+  class OutputPool {
+  private:
+    struct FileInfo {
+      std::string buffer;                          ///< Text not yet written to the file.
+      int fd = -1;                                 ///< Open descriptor (or -1 if closed).
+      bool started = false;                        ///< Has the file been created this run?
+      std::list<std::string>::iterator lru_pos;    ///< Position in open_files (if open).
+    };
+
+    std::unordered_map<std::string, FileInfo> files;
+    std::list<std::string> open_files;  ///< Open files, most recently used at the front.
+    size_t max_open = 64;               ///< Maximum descriptors to hold at once.
+    size_t buffer_size = 1 << 16;       ///< Bytes to collect per file before writing.
+    size_t num_opens = 0;               ///< Total number of open() calls (for tuning).
+
+    /// All pools still alive, so buffered output can be written out when exit() is called.
+    struct LivePools {
+      std::mutex mutex;
+      std::unordered_set<OutputPool *> pools;
+
+      static void FlushAll() {
+        LivePools & live = Get();
+        std::lock_guard lock(live.mutex);
+        for (OutputPool * pool : live.pools) pool->Flush();
+      }
+
+      static LivePools & Get() {
+        static LivePools live;
+        // Registered after live is built, so the handler runs before live is destroyed.
+        [[maybe_unused]] static const bool registered = (std::atexit(FlushAll) == 0);
+        return live;
+      }
+    };
+
+    void CloseFile(FileInfo & info) {
+      emp_assert(info.fd >= 0);
+      close(info.fd);
+      info.fd = -1;
+      open_files.erase(info.lru_pos);
+    }
+
+    void CloseOldest() { CloseFile(files[open_files.back()]); }
+
+    /// Make sure a file is open (closing the least recently used file if needed).
+    bool OpenFile(const std::string & filename, FileInfo & info) {
+      if (info.fd >= 0) {                          // Already open; mark as most recent.
+        open_files.splice(open_files.begin(), open_files, info.lru_pos);
+        return true;
+      }
+      while (open_files.size() && open_files.size() >= max_open) CloseOldest();
+      const int flags = O_WRONLY | O_CREAT | (info.started ? O_APPEND : O_TRUNC);
+      info.fd = open(filename.c_str(), flags, 0644);
+      if (info.fd < 0) {
+        std::cerr << "Error: unable to open output file '" << filename << "': "
+                  << std::strerror(errno) << std::endl;
+        return false;
+      }
+      info.started = true;
+      ++num_opens;
+      open_files.push_front(filename);
+      info.lru_pos = open_files.begin();
+      return true;
+    }
+
+    void FlushFile(const std::string & filename, FileInfo & info) {
+      if (info.buffer.empty() || !OpenFile(filename, info)) return;
+      const char * data = info.buffer.data();
+      size_t remaining = info.buffer.size();
+      while (remaining) {
+        const ssize_t written = write(info.fd, data, remaining);
+        if (written < 0) {
+          if (errno == EINTR) continue;
+          std::cerr << "Error: failed writing to '" << filename << "': "
+                    << std::strerror(errno) << std::endl;
+          break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+      }
+      info.buffer.clear();
+    }
+
+  public:
+    OutputPool() {
+      LivePools & live = LivePools::Get();
+      std::lock_guard lock(live.mutex);
+      live.pools.insert(this);
+    }
+    OutputPool(const OutputPool &) = delete;
+    OutputPool & operator=(const OutputPool &) = delete;
+    ~OutputPool() {
+      {
+        LivePools & live = LivePools::Get();
+        std::lock_guard lock(live.mutex);
+        live.pools.erase(this);
+      }
+      Flush();
+      while (open_files.size()) CloseOldest();
+    }
+
+    size_t GetMaxOpen() const { return max_open; }
+    size_t GetBufferSize() const { return buffer_size; }
+    size_t GetNumFiles() const { return files.size(); }
+    size_t GetNumOpen() const { return open_files.size(); }
+    size_t GetNumOpens() const { return num_opens; }
+
+    /// Limit the number of open descriptors (at least one); closes extras right away.
+    void SetMaxOpen(size_t in_max) {
+      max_open = in_max ? in_max : 1;
+      while (open_files.size() > max_open) CloseOldest();
+    }
+
+    void SetBufferSize(size_t in_size) { buffer_size = in_size; }
+
+    /// Has anything been written to this file during the run?
+    bool Has(const std::string & filename) const { return files.count(filename); }
+
+    void Write(const std::string & filename, std::string_view text) {
+      FileInfo & info = files[filename];
+      info.buffer.append(text);
+      if (info.buffer.size() >= buffer_size) FlushFile(filename, info);
+    }
+
+    /// Write out everything buffered for one file.
+    void Flush(const std::string & filename) {
+      auto it = files.find(filename);
+      if (it != files.end()) FlushFile(it->first, it->second);
+    }
+
+    /// Write out everything buffered for all files.
+    void Flush() {
+      for (auto & [filename, info] : files) FlushFile(filename, info);
+    }
+  };
+
+}
+
+#endif
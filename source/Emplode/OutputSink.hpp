@@ -0,0 +1,235 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  OutputSink.hpp
+ *  @brief Destination for PRINT / PRINTF output, plus the formatting they use.
+ *  @note Status: BETA
+ *
+ *  Each PRINT builds its full line in a string and hands it to the sink in a single write.
+ *  A sink may target:
+ *  - An ostream (std::cout by default).  The stream is only flushed after each line if it is
+ *    line buffered, which for std::cout is the case only when stdout is a terminal; otherwise
+ *    output is left to the stream's own block buffering.
+ *  - A file, opened with stdio so that buffered output is still written out if the program
+ *    calls exit().
+ *  - An in-memory string, mostly useful for tests.
+ *
+ *  PRINTF takes a C-style format string; conversions are: d i u o x X c s f F e E g G and %%
+ *  with the usual flags, width, and precision (but not '*').  Any value may be used with %s,
+ *  including lists.
+ */
+
+#ifndef EMPLODE_OUTPUT_SINK_HPP
+#define EMPLODE_OUTPUT_SINK_HPP
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+#include "emp/base/Ptr.hpp"
+#include "emp/base/vector.hpp"
+
+#include "Symbol.hpp"
+
+namespace emplode {
+
+  class OutputSink {
+  public:
+    enum class Mode { STREAM, FILE, STRING };
+
+  private:
+    Mode mode = Mode::STREAM;
+    std::ostream * stream = &std::cout;   ///< Target in STREAM mode.
+    bool line_buffered = false;           ///< Flush the stream after each line?
+    std::FILE * file = nullptr;           ///< Target in FILE mode.
+    std::string text;                     ///< Collected output in STRING mode.
+
+    void CloseFile() {
+      if (file) std::fclose(file);
+      file = nullptr;
+    }
+
+  public:
+    OutputSink() : line_buffered(isatty(STDOUT_FILENO)) { }
+    OutputSink(const OutputSink &) = delete;
+    OutputSink & operator=(const OutputSink &) = delete;
+    ~OutputSink() { Flush(); CloseFile(); }
+
+    Mode GetMode() const { return mode; }
+    bool IsLineBuffered() const { return line_buffered; }
+
+    /// Send output to a stream; by default, flush after each line only for a terminal's stdout.
+    void SetStream(std::ostream & in_stream) {
+      SetStream(in_stream, &in_stream == &std::cout && isatty(STDOUT_FILENO));
+    }
+
+    void SetStream(std::ostream & in_stream, bool in_line_buffered) {
+      Flush();
+      CloseFile();
+      mode = Mode::STREAM;
+      stream = &in_stream;
+      line_buffered = in_line_buffered;
+    }
+
+    /// Send output to a (truncated) file, block buffered.
+    void SetFile(const std::string & filename) {
+      Flush();
+      CloseFile();
+      file = std::fopen(filename.c_str(), "w");
+      if (!file) {
+        std::cerr << "Error: unable to open print file '" << filename << "': "
+                  << std::strerror(errno) << std::endl;
+        exit(1);
+      }
+      mode = Mode::FILE;
+    }
+
+    /// Collect output in memory (see GetString()).
+    void SetString() {
+      Flush();
+      CloseFile();
+      mode = Mode::STRING;
+      text.clear();
+    }
+
+    const std::string & GetString() const { return text; }
+    void ClearString() { text.clear(); }
+
+    void Write(std::string_view out) {
+      switch (mode) {
+        case Mode::STREAM:
+          stream->write(out.data(), static_cast<std::streamsize>(out.size()));
+          if (line_buffered) stream->flush();
+          break;
+        case Mode::FILE:
+          std::fwrite(out.data(), 1, out.size(), file);
+          break;
+        case Mode::STRING:
+          text.append(out);
+          break;
+      }
+    }
+
+    void Flush() {
+      if (mode == Mode::STREAM) stream->flush();
+      else if (mode == Mode::FILE) std::fflush(file);
+    }
+
+
+    // ---- Formatting ----
+
+    /// Append a number as an ostream would print it by default.
+    static void AppendNumber(std::string & out, double value) {
+      char buffer[32];
+      const int size = std::snprintf(buffer, sizeof(buffer), "%g", value);
+      out.append(buffer, static_cast<size_t>(size));
+    }
+
+    /// Append a symbol exactly as its Print() would write it.
+    static void AppendSymbol(std::string & out, const Symbol & symbol) {
+      // Script variables are printed directly; linked variables, lists, etc. print themselves.
+      if (symbol.IsLocal() && symbol.IsNumeric()) AppendNumber(out, symbol.AsDouble());
+      else if (symbol.IsLocal() && symbol.IsString()) out += symbol.AsString();
+      else {
+        std::stringstream ss;
+        symbol.Print(ss);
+        out += ss.str();
+      }
+    }
+
+    /// Append a single printf conversion (spec is the full "%..." text).
+    template <typename T>
+    static void AppendFormatted(std::string & out, const std::string & spec, T value) {
+      char buffer[64];
+      const int size = std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+      if (size < 0) return;
+      if (static_cast<size_t>(size) < sizeof(buffer)) {
+        out.append(buffer, static_cast<size_t>(size));
+        return;
+      }
+      const size_t start = out.size();
+      out.resize(start + size + 1);
+      std::snprintf(out.data() + start, size + 1, spec.c_str(), value);
+      out.resize(start + size);
+    }
+
+    /// Expand a printf-style format string using the arguments starting at first_arg.
+    static void AppendPrintf(std::string & out, std::string_view format,
+                             const emp::vector<emp::Ptr<Symbol>> & args, size_t first_arg=0) {
+      size_t arg_id = first_arg;
+      std::string spec;
+      for (size_t pos = 0; pos < format.size(); ++pos) {
+        const size_t next = format.find('%', pos);
+        if (next == std::string_view::npos) { out.append(format.substr(pos)); break; }
+        out.append(format.substr(pos, next - pos));
+
+        // Collect the conversion spec.
+        pos = next + 1;
+        const size_t spec_start = pos;
+        while (pos < format.size() && format[pos] && std::strchr("-+ #0", format[pos])) ++pos;
+        while (pos < format.size() && (std::isdigit(format[pos]) || format[pos] == '.')) ++pos;
+        if (pos == format.size()) {
+          std::cerr << "Error: PRINTF format ends with an incomplete conversion." << std::endl;
+          exit(1);
+        }
+        const char conversion = format[pos];
+        if (conversion == '%' && pos == spec_start) { out += '%'; continue; }
+        if (!conversion || !std::strchr("diuoxXcsfFeEgG", conversion)) {
+          std::cerr << "Error: unknown PRINTF conversion '%" << conversion << "'." << std::endl;
+          exit(1);
+        }
+        if (arg_id >= args.size()) {
+          std::cerr << "Error: PRINTF format needs more than the " << (args.size() - first_arg)
+                    << " value(s) provided." << std::endl;
+          exit(1);
+        }
+        const Symbol & arg = *args[arg_id++];
+        spec.assign("%").append(format.substr(spec_start, pos - spec_start));
+
+        switch (conversion) {
+          case 'd': case 'i':
+            (spec += "ll") += conversion;
+            AppendFormatted(out, spec, static_cast<long long>(arg.AsDouble()));
+            break;
+          case 'u': case 'o': case 'x': case 'X':
+            (spec += "ll") += conversion;
+            AppendFormatted(out, spec, static_cast<unsigned long long>(arg.AsDouble()));
+            break;
+          case 'c': {
+            const int c = arg.IsString() ? (arg.AsString().size() ? arg.AsString()[0] : 0)
+                                         : static_cast<int>(arg.AsDouble());
+            AppendFormatted(out, spec + 'c', c);
+            break;
+          }
+          case 's': {
+            std::string value;
+            AppendSymbol(value, arg);
+            if (pos == spec_start) out += value;      // Plain %s; no need to reformat.
+            else AppendFormatted(out, spec + 's', value.c_str());
+            break;
+          }
+          default:
+            AppendFormatted(out, spec + conversion, arg.AsDouble());
+        }
+      }
+
+      if (arg_id < args.size()) {
+        std::cerr << "Error: PRINTF given " << (args.size() - first_arg)
+                  << " values, but format uses only " << (arg_id - first_arg) << "." << std::endl;
+        exit(1);
+      }
+    }
+  };
+
+}
+
+#endif
@@ -42,6 +42,7 @@
 #define EMPLODE_PARSER_HPP
 
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "emp/base/Ptr.hpp"
@@ -50,6 +51,8 @@
 
 #include "AST.hpp"
 #include "Lexer.hpp"
+#include "ListMath.hpp"
+#include "Optimizer.hpp"
 #include "Symbol_Scope.hpp"
 #include "SymbolTable.hpp"
 
@@ -62,6 +65,10 @@ namespace emplode {
     emp::vector< emp::Ptr<Symbol_Scope> > scope_stack;
     emp::Ptr<Lexer> lexer;
 
+    /// Objects declared in a script are only built when run, so track the types they were
+    /// declared with (by Var ID) for checks made while parsing.
+    std::unordered_map<uintptr_t, emp::Ptr<const TypeInfo>> declared_types;
+
   public:
     ParseState(emp::TokenStream::Iterator _pos, SymbolTable & _table,
                Symbol_Scope & _scope, Lexer & _lexer)
@@ -112,6 +119,14 @@ namespace emplode {
     bool IsNumber() const { return pos && lexer->IsNumber(*pos); }
     bool IsString() const { return pos && lexer->IsString(*pos); }
 
+    void SetDeclaredType(const Var & var, const TypeInfo & type) {
+      declared_types[var.GetID()] = &type;
+    }
+    emp::Ptr<const TypeInfo> GetDeclaredType(const Var & var) const {
+      auto it = declared_types.find(var.GetID());
+      return (it == declared_types.end()) ? nullptr : it->second;
+    }
+
     bool IsSignal() const { return symbol_table->HasSignal(AsLexeme()); }
     bool IsType() const { return symbol_table->HasType(AsLexeme()); }
 
@@ -185,6 +200,11 @@ namespace emplode {
       if (AsChar() != req_char) Error(std::forward<Ts>(args)...);
       ++pos;      
     }
+    template <typename... Ts>
+    void UseRequiredLexeme(const std::string & lex, Ts &&... args) {
+      if (AsLexeme() != lex) Error(std::forward<Ts>(args)...);
+      ++pos;
+    }
 
     void PushScope(Symbol_Scope & _scope) { scope_stack.push_back(&_scope); }
     void PopScope() { scope_stack.pop_back(); }
@@ -227,6 +247,7 @@ namespace emplode {
   class Parser {
   private:
     std::unordered_map<std::string, size_t> precedence_map;  ///< Precedence levels for symbols.
+    Optimizer optimizer;     ///< Passes run on each statement as it is parsed.
 
     /// Print only when debugging.
     /// To activate debugging data, do: emp::notify::SetVerbose("emplode::Parser");
@@ -251,6 +272,8 @@ namespace emplode {
     }
     ~Parser() {}
 
+    Optimizer & GetOptimizer() { return optimizer; }
+
     /// Load a variable name from the provided scope.
     /// @param state the current state of parsing (token stream, symbol table, etc.)
     /// @param create_ok indicates if we should create any variables that we don't find.
@@ -269,6 +292,10 @@ namespace emplode {
                                                      emp::Ptr<ASTNode> value1,
                                                      emp::Ptr<ASTNode> value2);
 
+    /// If a call is to a member function with a fixed number of parameters (from a member table)
+    /// on an object of known type, make sure it is given the right number of arguments.
+    void CheckMemberArgs(ParseState & state, emp::Ptr<ASTNode> fun_node, size_t num_args);
+
     /// Calculate a full expression found in a token sequence, using the provided scope.
     /// @param state The current start of the parser and input stream
     /// @param decl_ok Can this expression begin with a declaration of a variable?
@@ -432,6 +459,18 @@ namespace emplode {
     else if (symbol == "&&") out_val->SetFun( [](emp::Datum v1, emp::Datum v2){ return v1 && v2; } );
     else if (symbol == "||") out_val->SetFun( [](emp::Datum v1, emp::Datum v2){ return v1 || v2; } );
 
+    // Arithmetic is applied elementwise if either side is a list.
+    ListMath::kernel_t list_kernel;
+    if (symbol == "+") list_kernel = ListMath::Kernel<ListMath::OpAdd>;
+    else if (symbol == "-") list_kernel = ListMath::Kernel<ListMath::OpSub>;
+    else if (symbol == "*") list_kernel = ListMath::Kernel<ListMath::OpMul>;
+    else if (symbol == "/") list_kernel = ListMath::Kernel<ListMath::OpDiv>;
+    if (list_kernel) {
+      out_val->SetListFun( [symbol, list_kernel](emp::Ptr<Symbol> v1, emp::Ptr<Symbol> v2){
+        return ListMath::Broadcast(symbol, {v1, v2}, list_kernel);
+      } );
+    }
+
     out_val->AddChild(in_node1);
     out_val->AddChild(in_node2);
 
@@ -444,6 +483,24 @@ namespace emplode {
   /// @param decl_ok Can this expression begin with a declaration of a variable?
   /// @param prec_limit What is the highest precedence that expression should process?
 
+  void Parser::CheckMemberArgs(ParseState & state, emp::Ptr<ASTNode> fun_node, size_t num_args) {
+    auto member_node = fun_node.DynamicCast<ASTNode_Member>();
+    if (!member_node) return;
+    auto obj_node = member_node->GetChild(0).DynamicCast<ASTNode_Var>();
+    if (!obj_node || obj_node->GetVar().IsLinked()) return;
+
+    // Objects declared in a script are only built when run, so use their declared type.
+    emp::Ptr<const TypeInfo> type_info = state.GetDeclaredType(obj_node->GetVar());
+    if (!type_info) type_info = obj_node->GetSymbol().GetTypeInfoPtr();
+    if (!type_info) return;
+
+    emp::Ptr<const MemberFunInfo> fun_info = type_info->GetMemberFunction(member_node->GetName());
+    if (!fun_info || fun_info->num_params < 0) return;
+    state.Require(fun_info->num_params == static_cast<int>(num_args),
+                  "Member function '", obj_node->GetName(), ".", fun_info->name, "' expects ",
+                  fun_info->num_params, " arguments, but was given ", num_args, ".");
+  }
+
   emp::Ptr<ASTNode> Parser::ParseExpression(ParseState & state, bool decl_ok, size_t prec_limit) {
     Debug("Running ParseExpression(", state.AsString(), ", decl_ok=", decl_ok, ", limit=", prec_limit, ")");
 
@@ -474,7 +531,7 @@ namespace emplode {
       cur_node = ParseValue(state, state.GetScope().GetDesc() == "Struct initialization scope");
     }
 
-    while (state.UseIfChar('.')) {
+    while (state.UseIfLexeme(".")) {
       state.RequireID("Expected member name after '.'");
       std::string name = state.UseLexeme();
       auto node = emp::NewPtr<ASTNode_Member>(name);
@@ -500,10 +557,11 @@ namespace emplode {
           ++state;                           // Move on to the next argument.
         }
         state.UseRequiredChar(')', "Expected a ')' to end function call.");
+        CheckMemberArgs(state, cur_node, args.size());
 
         // cur_node should have evaluated itself to a function; a Call node will link that
         // function with its arguments, run it, and return the result.
-        cur_node = emp::NewPtr<ASTNode_Call>(cur_node, args, op_token.line_id);
+        cur_node = optimizer.InlineCall(emp::NewPtr<ASTNode_Call>(cur_node, args, op_token.line_id));
       }
       // Do we have an array subscript?
       else if (op == "[") {
@@ -516,6 +574,12 @@ namespace emplode {
       }
       // Otherwise we must have a binary math operation.
       else {
+        // Built-in functions may be shared between instances, so they can never be replaced.
+        if (op == "=") {
+          auto var_node = cur_node.DynamicCast<ASTNode_Var>();
+          state.Require(!var_node || !var_node->IsBuiltinFunction(),
+                        "Cannot assign to built-in function '", cur_node->GetName(), "'.");
+        }
         emp::Ptr<ASTNode> node2 = ParseExpression(state, false, precedence_map[op]);
         cur_node = ProcessOperation(op_token, cur_node, node2);
       }
@@ -572,6 +636,7 @@ namespace emplode {
     // Otherwise we have an object of a custom type to add.
     Debug("Building object '", var_name, "' of type '", type_name, "'");
     Var var = state.AddLocalVar(var_name, "Local object.");
+    state.SetDeclaredType(var, state.GetSymbolTable().GetType(type_name));
     // If we're about to assign to the object, don't initialize it
     if (state.AsLexeme() == "=")
       return emp::NewPtr<ASTNode_Var>(var, var_name);
@@ -587,17 +652,55 @@ namespace emplode {
     state.UseRequiredChar('@', "All event declarations must being with an '@'.");
     state.RequireID("Events must start by specifying signal name.");
     const std::string & trigger_name = state.UseLexeme();
-    state.UseRequiredChar('(', "Expected parentheses after '", trigger_name, "' for args.");
 
+    // Args are optional when another clause follows, as in "@UPDATE EVERY 100 ..."
     emp::vector<emp::Ptr<ASTNode>> args;
-    while (state.AsChar() != ')') {
-      args.push_back( ParseExpression(state, true) );
-      state.UseIfChar(',');                     // Skip comma if next (does allow trailing comma)
+    const std::string & next = state.AsLexeme();
+    const bool has_clause = next == "AT" || next == "EVERY" || next == "PRIORITY" || next == "WHEN";
+    if (!has_clause) {
+      state.UseRequiredChar('(', "Expected parentheses after '", trigger_name, "' for args.");
+      while (state.AsChar() != ')') {
+        args.push_back( ParseExpression(state, true) );
+        state.UseIfChar(',');                   // Skip comma if next (does allow trailing comma)
+      }
+      state.UseRequiredChar(')', "Event args must end in a ')'");
     }
-    state.UseRequiredChar(')', "Event args must end in a ')'");
 
     auto action_block = emp::NewPtr<ASTNode_Block>(state.GetScope(), state.GetLine());
     action_block->SetSymbolTable(state.GetSymbolTable());
+
+    // Collect any priority, schedule, and guard for this action (in that order).
+    double priority = 0.0;
+    if (state.UseIfLexeme("PRIORITY")) {
+      const bool negative = state.UseIfChar('-');
+      state.RequireNumber("PRIORITY must be followed by a literal number.");
+      priority = emp::from_string<double>(state.UseLexeme());
+      if (negative) priority = -priority;
+    }
+
+    EventSchedule schedule;
+    if (state.UseIfLexeme("EVERY")) {
+      schedule.every = ParseExpression(state);
+      if (state.UseIfLexeme("FROM")) schedule.from = ParseExpression(state);
+      if (state.UseIfLexeme("UNTIL")) schedule.until = ParseExpression(state);
+    }
+    else if (state.UseIfLexeme("AT")) {
+      schedule.from = ParseExpression(state);
+      schedule.is_at = true;
+    }
+
+    emp::Ptr<ASTNode> guard = nullptr;
+    if (state.UseIfLexeme("WHEN")) {
+      state.UseRequiredChar('(', "Expected '(' to begin WHEN test for event '", trigger_name, "'.");
+      guard = ParseExpression(state);
+      state.UseRequiredChar(')', "Expected ')' to end WHEN test for event '", trigger_name, "'.");
+    }
+
+    // Schedule and guard expressions are evaluated in the scope of the action.
+    for (emp::Ptr<ASTNode> node : {schedule.every, schedule.from, schedule.until, guard}) {
+      if (node) node->SetParent(action_block);
+    }
+
     emp::Ptr<ASTNode> action_node = ParseStatement(state);
 
     // If the action statement is real, add it to the action block.
@@ -605,7 +708,7 @@ namespace emplode {
 
     Debug("Building event '", trigger_name, "' with args ", args);
 
-    state.AddAction(trigger_name, args, action_block, start_token.line_id);
+    state.AddAction(trigger_name, args, action_block, start_token.line_id, schedule, priority, guard);
 
     return nullptr;
   }
@@ -616,7 +719,7 @@ namespace emplode {
 
     if (state.UseIfLexeme("IF")) {
       state.UseRequiredChar('(', "Expected '(' to begin IF test condition.");
-      emp::Ptr<ASTNode> test_node = ParseExpression(state);
+      emp::Ptr<ASTNode> test_node = optimizer.ShareSubexpressions(ParseExpression(state));
       state.UseRequiredChar(')', "Expected ')' to end IF test condition.");
       emp::Ptr<ASTNode> true_node = ParseStatement(state);
       emp::Ptr<ASTNode> else_node = nullptr;
@@ -626,10 +729,63 @@ namespace emplode {
 
     else if (state.UseIfLexeme("WHILE")) {
       state.UseRequiredChar('(', "Expected '(' to begin IF test condition.");
-      emp::Ptr<ASTNode> test_node = ParseExpression(state);
+      emp::Ptr<ASTNode> test_node = optimizer.ShareSubexpressions(ParseExpression(state));
       state.UseRequiredChar(')', "Expected ')' to end IF test condition.");
       emp::Ptr<ASTNode> body_node = ParseStatement(state);
-      return emp::NewPtr<ASTNode_While>(test_node, body_node, keyword_line);
+      auto while_node = emp::NewPtr<ASTNode_While>(test_node, body_node, keyword_line);
+      return optimizer.HoistInvariants(while_node);
+    }
+
+    // FOR (init; test; step) body, or FOR (i IN start..end) body; variables declared in the
+    // loop header or body are local to the loop.
+    else if (state.UseIfLexeme("FOR")) {
+      state.UseRequiredChar('(', "Expected '(' to begin FOR loop.");
+      auto scope = emp::NewPtr<Symbol_Scope>("FOR", "Loop scope", &state.GetScope());
+      state.PushScope(*scope);
+
+      // Look ahead for the range form: [Var] name IN
+      ParseState ahead = state;
+      if (ahead.IsType()) ++ahead;
+      const bool is_range = ahead.IsID() && (++ahead).AsLexeme() == "IN";
+
+      emp::Ptr<ASTNode_For> for_node;
+      if (is_range) {
+        emp::Ptr<ASTNode_Var> var_node;
+        if (state.IsType()) {
+          state.Require(state.AsLexeme() == "Var", "FOR loop variable must be declared as a Var.");
+          var_node = ParseDeclaration(state).DynamicCast<ASTNode_Var>();
+        }
+        else if (state.GetScope().LookupSymbol(state.AsLexeme(), true).has_value()) {
+          var_node = ParseVar(state, false, true);
+        }
+        else {
+          const std::string var_name = state.UseLexeme();
+          var_node = emp::NewPtr<ASTNode_Var>(state.AddLocalVar(var_name, "Loop variable."), var_name);
+        }
+        state.Require(!var_node->GetVar().IsLinked(), "FOR loop variable '", var_node->GetName(),
+                      "' must be a script variable.");
+        state.UseRequiredLexeme("IN", "Expected 'IN' after FOR loop variable.");
+        emp::Ptr<ASTNode> start_node = ParseExpression(state);
+        state.UseRequiredLexeme("..", "Expected '..' between start and end of FOR range.");
+        emp::Ptr<ASTNode> end_node = ParseExpression(state);
+        state.UseRequiredChar(')', "Expected ')' to end FOR range.");
+        emp::Ptr<ASTNode> body_node = ParseStatement(state);
+        for_node = emp::NewPtr<ASTNode_For>(scope, var_node, start_node, end_node, body_node, keyword_line);
+      }
+      else {
+        emp::Ptr<ASTNode> init_node = optimizer.ShareSubexpressions(ParseExpression(state, true));
+        state.UseRequiredChar(';', "Expected ';' after FOR loop initialization.");
+        emp::Ptr<ASTNode> test_node = ParseExpression(state);
+        state.UseRequiredChar(';', "Expected ';' after FOR loop test.");
+        emp::Ptr<ASTNode> step_node = ParseExpression(state);
+        state.UseRequiredChar(')', "Expected ')' to end FOR loop header.");
+        emp::Ptr<ASTNode> body_node = ParseStatement(state);
+        for_node = emp::NewPtr<ASTNode_For>(scope, init_node, test_node, step_node, body_node, keyword_line);
+      }
+      state.PopScope();
+
+      optimizer.UnboxCounter(for_node);
+      return optimizer.HoistInvariants(for_node);
     }
 
     else if (state.UseIfLexeme("BREAK")) { return MakeBreakLeaf(keyword_line); }
@@ -640,10 +796,78 @@ namespace emplode {
       auto node = emp::NewPtr<ASTNode_Return>(keyword_line);
       // Allow return without a value if it's followed by a semicolon
       if (state.AsChar() != ';')
-        node->AddChild(ParseExpression(state));
+        node->AddChild(optimizer.ShareSubexpressions(ParseExpression(state)));
       return node;
     }
 
+    // PURE Var name(params) { ... } declares a function without side effects; PURE(size) also
+    // keeps up to size recent results (see MemoCache.hpp).
+    else if (state.UseIfLexeme("PURE")) {
+      size_t memo_size = 0;
+      if (state.UseIfChar('(')) {
+        state.RequireNumber("Expected memo size after 'PURE('.");
+        memo_size = emp::from_string<size_t>(state.UseLexeme());
+        state.UseRequiredChar(')', "Expected ')' after PURE memo size.");
+      }
+      state.Require(state.IsType(), "PURE must be followed by a function declaration.");
+      auto fun_node = ParseDeclaration(state).DynamicCast<ASTNode_Var>();
+      state.Require(fun_node && fun_node->GetSymbol().IsFunction(),
+                    "PURE must be followed by a function declaration.");
+      emp::Ptr<Symbol_Function> fun = fun_node->GetSymbol().AsFunctionPtr();
+      fun->SetPure();
+      fun->SetMemo(memo_size);
+      return fun_node;
+    }
+
+    // SIGNAL name(param1, param2, ...); declares a new signal; parameter names are descriptive.
+    else if (state.UseIfLexeme("SIGNAL")) {
+      state.RequireID("Expected name of signal to declare.");
+      const std::string signal_name = state.UseLexeme();
+      state.Require(!state.GetSymbolTable().HasSignal(signal_name),
+                    "Signal '", signal_name, "' already exists.");
+      int num_params = 0;
+      if (state.UseIfChar('(')) {
+        while (state.AsChar() != ')') {
+          state.RequireID("Expected parameter name in declaration of signal '", signal_name, "'.");
+          state.UseLexeme();
+          ++num_params;
+          state.UseIfChar(',');
+        }
+        state.UseRequiredChar(')', "Signal parameters must end in a ')'.");
+      }
+      state.UseRequiredChar(';', "Expected ';' after declaration of signal '", signal_name, "'.");
+      state.GetSymbolTable().AddSignal(signal_name, num_params);
+      return nullptr;
+    }
+
+    // TRIGGER name(args); runs (or queues, if deferred) all actions for the signal.
+    else if (state.UseIfLexeme("TRIGGER")) {
+      state.RequireID("Expected name of signal to trigger.");
+      const std::string signal_name = state.UseLexeme();
+      state.Require(state.GetSymbolTable().HasSignal(signal_name),
+                    "Unknown signal '", signal_name, "' in TRIGGER.");
+      emp::vector<emp::Ptr<ASTNode>> args;
+      if (state.UseIfChar('(')) {
+        while (state.AsChar() != ')') {
+          args.push_back( ParseExpression(state) );
+          state.UseIfChar(',');
+        }
+        state.UseRequiredChar(')', "Trigger args must end in a ')'.");
+      }
+      const int num_params = state.GetSymbolTable().GetSignalParams(signal_name);
+      state.Require(num_params < 0 || static_cast<int>(args.size()) == num_params,
+                    "Signal '", signal_name, "' expects ", num_params, " arguments, but TRIGGER gave ",
+                    args.size(), ".");
+      state.UseRequiredChar(';', "Expected ';' after TRIGGER of '", signal_name, "'.");
+
+      SymbolTable & symbol_table = state.GetSymbolTable();
+      const size_t signal_id = symbol_table.GetSignalID(signal_name);
+      return optimizer.ShareSubexpressions(emp::NewPtr<ASTNode_Trigger>(signal_name, args,
+        [&symbol_table, signal_id](const emp::vector<emp::Ptr<Symbol>> & args){
+          symbol_table.TriggerSymbols(signal_id, args);
+        }, keyword_line));
+    }
+
     // If we made it this far, we have an error.  Identify and deal with it!
 
     if (state.UseIfLexeme("ELSE")) state.Error("'ELSE' must be preceded by an 'IF' statement.");
@@ -679,7 +903,7 @@ namespace emplode {
     // Expressions must end in a semi-colon.
     state.UseRequiredChar(';', "Expected ';' at the end of a statement; found: ", state.AsLexeme());
 
-    return out_node;
+    return optimizer.ShareSubexpressions(out_node);
   }  
 }
 #endif
@@ -0,0 +1,168 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Random.hpp
+ *  @brief A small, fast, reproducible random number generator for built-in script functions.
+ *  @note Status: BETA
+ *
+ *  Random uses the xoshiro256** generator (Blackman & Vigna), with its state filled from a
+ *  64-bit seed via SplitMix64.  A generator is identified by a seed AND a stream id; different
+ *  streams with the same seed produce independent sequences, so each Emplode instance (or
+ *  each thread with its own instance) can draw numbers without sharing state.
+ */
+
+#ifndef EMPLODE_RANDOM_HPP
+#define EMPLODE_RANDOM_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "emp/base/assert.hpp"
+
+namespace emplode {
+
+  class Random {
+  private:
+    uint64_t state[4];
+    uint64_t seed = 0;
+    uint64_t stream = 0;
+    double spare_normal = 0.0;        ///< Second value from the last polar-method draw.
+    bool has_spare_normal = false;
+
+    static constexpr uint64_t RotateLeft(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    static uint64_t SplitMix64(uint64_t & x) {
+      uint64_t z = (x += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      return z ^ (z >> 31);
+    }
+
+    /// Poisson draw for large means using transformed rejection (Hormann, 1993).
+    uint64_t GetPoissonPTRS(double mean) {
+      const double slam = std::sqrt(mean);
+      const double loglam = std::log(mean);
+      const double b = 0.931 + 2.53 * slam;
+      const double a = -0.059 + 0.02483 * b;
+      const double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+      const double vr = 0.9277 - 3.6224 / (b - 2.0);
+
+      while (true) {
+        const double U = GetDouble() - 0.5;
+        const double V = GetDouble();
+        const double us = 0.5 - std::abs(U);
+        const double k = std::floor((2.0 * a / us + b) * U + mean + 0.43);
+        if (us >= 0.07 && V <= vr) return static_cast<uint64_t>(k);
+        if (k < 0.0 || (us < 0.013 && V > us)) continue;
+        if (std::log(V) + std::log(invalpha) - std::log(a / (us * us) + b) <=
+            -mean + k * loglam - std::lgamma(k + 1.0)) {
+          return static_cast<uint64_t>(k);
+        }
+      }
+    }
+
+  public:
+    Random(uint64_t _seed=0, uint64_t _stream=0) { ResetSeed(_seed, _stream); }
+
+    uint64_t GetSeed() const { return seed; }
+    uint64_t GetStream() const { return stream; }
+
+    /// Restart the generator from a seed; each stream id gives an independent sequence.
+    void ResetSeed(uint64_t _seed, uint64_t _stream=0) {
+      seed = _seed;
+      stream = _stream;
+      uint64_t x = seed ^ (stream * 0xd1342543de82ef95);
+      SplitMix64(x);                  // Decorrelate nearby seeds and streams.
+      for (uint64_t & s : state) s = SplitMix64(x);
+      has_spare_normal = false;
+    }
+
+    /// Raw 64 random bits.
+    uint64_t GetUInt64() {
+      const uint64_t result = RotateLeft(state[1] * 5, 7) * 9;
+      const uint64_t t = state[1] << 17;
+      state[2] ^= state[0];
+      state[3] ^= state[1];
+      state[1] ^= state[2];
+      state[0] ^= state[3];
+      state[2] ^= t;
+      state[3] = RotateLeft(state[3], 45);
+      return result;
+    }
+
+    /// Uniform value in [0, 1).
+    double GetDouble() { return static_cast<double>(GetUInt64() >> 11) * 0x1.0p-53; }
+
+    /// Uniform value in [min, max).
+    double GetDouble(double min, double max) { return min + (max - min) * GetDouble(); }
+
+    /// Unbiased uniform integer in [0, max), using multiply-and-shift with rejection.
+    uint64_t GetUInt(uint64_t max) {
+      emp_assert(max > 0);
+      __uint128_t m = static_cast<__uint128_t>(GetUInt64()) * max;
+      uint64_t low = static_cast<uint64_t>(m);
+      if (low < max) {
+        const uint64_t threshold = -max % max;
+        while (low < threshold) {
+          m = static_cast<__uint128_t>(GetUInt64()) * max;
+          low = static_cast<uint64_t>(m);
+        }
+      }
+      return static_cast<uint64_t>(m >> 64);
+    }
+
+    /// Uniform integer in [min, max).
+    int64_t GetInt(int64_t min, int64_t max) {
+      emp_assert(min < max, min, max);
+      return min + static_cast<int64_t>(GetUInt(static_cast<uint64_t>(max - min)));
+    }
+
+    /// Normally distributed value (Marsaglia polar method; values are generated in pairs).
+    double GetNormal(double mean=0.0, double std=1.0) {
+      if (has_spare_normal) {
+        has_spare_normal = false;
+        return mean + std * spare_normal;
+      }
+      double u, v, s;
+      do {
+        u = 2.0 * GetDouble() - 1.0;
+        v = 2.0 * GetDouble() - 1.0;
+        s = u * u + v * v;
+      } while (s >= 1.0 || s == 0.0);
+      const double scale = std::sqrt(-2.0 * std::log(s) / s);
+      spare_normal = v * scale;
+      has_spare_normal = true;
+      return mean + std * u * scale;
+    }
+
+    /// Poisson-distributed count with the provided mean.
+    uint64_t GetPoisson(double mean) {
+      emp_assert(mean >= 0.0, mean);
+      if (mean >= 10.0) return GetPoissonPTRS(mean);
+
+      // Small means: multiply uniform draws until the product drops below e^-mean.
+      const double limit = std::exp(-mean);
+      uint64_t count = 0;
+      double prod = GetDouble();
+      while (prod > limit) {
+        ++count;
+        prod *= GetDouble();
+      }
+      return count;
+    }
+
+    /// Randomly reorder a range in place (Fisher-Yates).
+    template <typename T>
+    void Shuffle(T & container) {
+      for (size_t i = container.size(); i > 1; --i) {
+        std::swap(container[i-1], container[GetUInt(i)]);
+      }
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,318 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  SharedExport.hpp
+ *  @brief Publish live numeric values through a POSIX shared-memory segment.
+ *  @note Status: BETA
+ *
+ *  A SharedExport owns a named shared-memory segment (see shm_open) holding a fixed list of
+ *  named values.  Each Publish() updates all of the values at once under a sequence lock: the
+ *  sequence number is odd while an update is in progress, and readers retry if it was odd or
+ *  changed while they were reading.  The writer never waits on readers.
+ *
+ *  A SharedReader maps the same segment read-only, so a separate monitoring process can read
+ *  values in place (no copying through files or pipes).  The set of names is fixed once the
+ *  segment is opened; the segment is removed when the SharedExport is destroyed.
+ *
+ *  Segments are created exclusively.  The header records the writer's process id, so a segment
+ *  left behind by a run that died without cleaning up is unlinked and replaced; a segment whose
+ *  writer is still alive is reported as an error rather than taken over.
+ *
+ *  Including this file also makes the "shared" DataFile backend available (see
+ *  SharedExportBase.hpp); this is the only Emplode header that needs the POSIX headers below.
+ */
+
+#ifndef EMPLODE_SHARED_EXPORT_HPP
+#define EMPLODE_SHARED_EXPORT_HPP
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/vector.hpp"
+
+#include "SharedExportBase.hpp"
+
+namespace emplode {
+
+  /// Memory layout of an export segment; shared by writers and readers.
+  struct SharedExportLayout {
+    static constexpr uint64_t MAGIC = 0x3245444F4C504D45;   // "EMPLODE2" (little endian)
+    static constexpr size_t NAME_SIZE = 56;
+
+    struct alignas(64) Header {
+      std::atomic<uint64_t> magic;      ///< Set last, once names are in place.
+      uint64_t num_values;
+      int64_t owner_pid;                ///< Process that created (and publishes to) the segment.
+      alignas(64) std::atomic<uint64_t> sequence;  ///< Odd while an update is in progress.
+    };
+
+    struct Entry {
+      char name[NAME_SIZE];             ///< Null-terminated (truncated if needed).
+      std::atomic<uint64_t> bits;       ///< Bit pattern of the current double value.
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Shared exports need lock-free 64-bit atomics.");
+
+    static size_t GetSize(size_t num_values) { return sizeof(Header) + num_values * sizeof(Entry); }
+    static Entry * GetEntries(Header * header) { return reinterpret_cast<Entry *>(header + 1); }
+    static const Entry * GetEntries(const Header * header) {
+      return reinterpret_cast<const Entry *>(header + 1);
+    }
+
+    static std::string ToSegmentName(const std::string & name) {
+      return SharedExportBase::ToSegmentName(name);
+    }
+  };
+
+  class SharedExport : public SharedExportBase {
+  private:
+    using layout_t = SharedExportLayout;
+
+    struct ValueInfo {
+      std::string name;
+      std::function<double()> get_fun;
+    };
+
+    std::string segment_name;
+    emp::vector<ValueInfo> values;
+    emp::vector<double> scratch;        ///< Values gathered before the update begins.
+    layout_t::Header * header = nullptr;
+    size_t segment_size = 0;
+
+  public:
+    SharedExport(const std::string & name) : segment_name(layout_t::ToSegmentName(name)) { }
+    SharedExport(const SharedExport &) = delete;
+    SharedExport & operator=(const SharedExport &) = delete;
+    ~SharedExport() { Close(); }
+
+    const std::string & GetSegmentName() const override { return segment_name; }
+    size_t GetNumValues() const override { return values.size(); }
+    bool IsOpen() const { return header != nullptr; }
+
+    /// Export a value computed on each Publish(); must be called before the segment opens.
+    /// Values without a function can only be updated through Publish(new_values).
+    size_t AddValue(const std::string & name, std::function<double()> get_fun=nullptr) override {
+      emp_assert(!IsOpen(), "Values must be added before the shared segment is opened.");
+      values.push_back(ValueInfo{name, get_fun});
+      return values.size() - 1;
+    }
+
+    /// Export a (linked) variable; it must outlive this exporter.
+    template <typename T>
+    size_t AddVar(const std::string & name, const T & var) {
+      return AddValue(name, [&var](){ return static_cast<double>(var); });
+    }
+
+    /// Is an existing segment left over from a writer that is no longer running?
+    static bool IsStale(const std::string & segment_name) {
+      const int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+      if (fd < 0) return errno == ENOENT;             // Already gone; just retry.
+      struct stat info;
+      bool stale = false;
+      if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(layout_t::Header)) {
+        void * mem = mmap(nullptr, sizeof(layout_t::Header), PROT_READ, MAP_SHARED, fd, 0);
+        if (mem != MAP_FAILED) {
+          const auto * header = static_cast<const layout_t::Header *>(mem);
+          if (header->magic.load(std::memory_order_acquire) == layout_t::MAGIC) {
+            const pid_t owner = static_cast<pid_t>(header->owner_pid);
+            stale = owner > 0 && kill(owner, 0) != 0 && errno == ESRCH;
+          }
+          munmap(mem, sizeof(layout_t::Header));
+        }
+      }
+      close(fd);
+      return stale;
+    }
+
+    /// Create the segment with the current set of names; returns false on failure, including
+    /// when another live process already owns a segment with this name.
+    bool Open() {
+      if (IsOpen()) return true;
+      segment_size = layout_t::GetSize(values.size());
+      int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if (fd < 0 && errno == EEXIST && IsStale(segment_name)) {
+        shm_unlink(segment_name.c_str());
+        fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      }
+      if (fd < 0 && errno == EEXIST) {
+        std::cerr << "Error: shared segment '" << segment_name
+                  << "' is already in use by another process." << std::endl;
+        return false;
+      }
+      if (fd < 0 || ftruncate(fd, segment_size) != 0) {
+        std::cerr << "Error: unable to create shared segment '" << segment_name << "': "
+                  << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+          close(fd);
+          shm_unlink(segment_name.c_str());
+        }
+        return false;
+      }
+      void * mem = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (mem == MAP_FAILED) {
+        std::cerr << "Error: unable to map shared segment '" << segment_name << "': "
+                  << std::strerror(errno) << std::endl;
+        shm_unlink(segment_name.c_str());
+        return false;
+      }
+
+      header = new (mem) layout_t::Header;
+      header->magic.store(0, std::memory_order_relaxed);
+      header->num_values = values.size();
+      header->owner_pid = getpid();
+      header->sequence.store(0, std::memory_order_relaxed);
+      layout_t::Entry * entries = layout_t::GetEntries(header);
+      for (size_t i = 0; i < values.size(); ++i) {
+        layout_t::Entry * entry = new (&entries[i]) layout_t::Entry;
+        std::strncpy(entry->name, values[i].name.c_str(), layout_t::NAME_SIZE - 1);
+        entry->name[layout_t::NAME_SIZE - 1] = '\0';
+        entry->bits.store(std::bit_cast<uint64_t>(0.0), std::memory_order_relaxed);
+      }
+      header->magic.store(layout_t::MAGIC, std::memory_order_release);
+      scratch.resize(values.size());
+      return true;
+    }
+
+    /// Unmap and remove the segment (readers that already mapped it keep their view).
+    void Close() {
+      if (!IsOpen()) return;
+      munmap(header, segment_size);
+      shm_unlink(segment_name.c_str());
+      header = nullptr;
+    }
+
+    /// Write a full set of values (one per name) as a single update.
+    void Publish(const emp::vector<double> & new_values) override {
+      if (!IsOpen() && !Open()) return;
+      emp_assert(new_values.size() == values.size(), new_values.size(), values.size());
+      layout_t::Entry * entries = layout_t::GetEntries(header);
+      const uint64_t seq = header->sequence.load(std::memory_order_relaxed);
+      header->sequence.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for (size_t i = 0; i < new_values.size(); ++i) {
+        entries[i].bits.store(std::bit_cast<uint64_t>(new_values[i]), std::memory_order_relaxed);
+      }
+      header->sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /// Collect every exported value, then publish them together.
+    void Publish() {
+      scratch.resize(values.size());
+      for (size_t i = 0; i < values.size(); ++i) {
+        emp_assert(values[i].get_fun, "Exported value has no function to collect it.", values[i].name);
+        scratch[i] = values[i].get_fun();
+      }
+      Publish(scratch);
+    }
+  };
+
+  namespace internal {
+    /// Make this implementation available to DataFile's "shared" backend.
+    inline const bool shared_export_registered = [](){
+      SharedExportBase::Factory() = [](const std::string & name) -> std::shared_ptr<SharedExportBase> {
+        return std::make_shared<SharedExport>(name);
+      };
+      return true;
+    }();
+  }
+
+  class SharedReader {
+  private:
+    using layout_t = SharedExportLayout;
+
+    const layout_t::Header * header = nullptr;
+    size_t segment_size = 0;
+
+  public:
+    SharedReader() = default;
+    SharedReader(const SharedReader &) = delete;
+    SharedReader & operator=(const SharedReader &) = delete;
+    ~SharedReader() { Close(); }
+
+    /// Map an existing segment; returns false if it does not exist or is not ready yet.
+    bool Open(const std::string & name) {
+      Close();
+      const std::string segment_name = layout_t::ToSegmentName(name);
+      const int fd = shm_open(segment_name.c_str(), O_RDONLY, 0);
+      if (fd < 0) return false;
+      struct stat info;
+      if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(layout_t::Header)) {
+        close(fd);
+        return false;
+      }
+      segment_size = info.st_size;
+      void * mem = mmap(nullptr, segment_size, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (mem == MAP_FAILED) return false;
+
+      header = static_cast<const layout_t::Header *>(mem);
+      if (header->magic.load(std::memory_order_acquire) != layout_t::MAGIC ||
+          layout_t::GetSize(header->num_values) > segment_size) {
+        Close();
+        return false;
+      }
+      return true;
+    }
+
+    void Close() {
+      if (!header) return;
+      munmap(const_cast<layout_t::Header *>(header), segment_size);
+      header = nullptr;
+    }
+
+    bool IsOpen() const { return header != nullptr; }
+    size_t GetNumValues() const { return header->num_values; }
+    const char * GetName(size_t id) const { return layout_t::GetEntries(header)[id].name; }
+
+    /// Number of completed updates so far.
+    uint64_t GetNumUpdates() const {
+      return header->sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    /// Latest value of a single entry, read in place.
+    double GetValue(size_t id) const {
+      emp_assert(id < GetNumValues(), id, GetNumValues());
+      const uint64_t bits = layout_t::GetEntries(header)[id].bits.load(std::memory_order_acquire);
+      return std::bit_cast<double>(bits);
+    }
+
+    /// Read a consistent snapshot of every value (all from the same update); returns the
+    /// number of updates it reflects.
+    uint64_t Read(emp::vector<double> & out) const {
+      const layout_t::Entry * entries = layout_t::GetEntries(header);
+      out.resize(GetNumValues());
+      while (true) {
+        const uint64_t seq1 = header->sequence.load(std::memory_order_acquire);
+        if (seq1 & 1) continue;                       // Update in progress.
+        for (size_t i = 0; i < out.size(); ++i) {
+          out[i] = std::bit_cast<double>(entries[i].bits.load(std::memory_order_relaxed));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t seq2 = header->sequence.load(std::memory_order_relaxed);
+        if (seq1 == seq2) return seq1 / 2;
+      }
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  SharedExportBase.hpp
+ *  @brief Interface to a shared-memory export, free of any platform headers.
+ *  @note Status: BETA
+ *
+ *  DataFile only needs to create an export, name its values, and publish rows, so it works
+ *  through this interface.  The POSIX implementation lives in SharedExport.hpp, which
+ *  registers itself as the factory when it is included; a program that never includes it
+ *  does not pull in the shared-memory headers, and cannot use the "shared" backend.
+ */
+
+#ifndef EMPLODE_SHARED_EXPORT_BASE_HPP
+#define EMPLODE_SHARED_EXPORT_BASE_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "emp/base/vector.hpp"
+
+namespace emplode {
+
+  class SharedExportBase {
+  public:
+    using factory_t = std::shared_ptr<SharedExportBase> (*)(const std::string & name);
+
+    virtual ~SharedExportBase() { }
+
+    virtual const std::string & GetSegmentName() const = 0;
+    virtual size_t GetNumValues() const = 0;
+    virtual size_t AddValue(const std::string & name, std::function<double()> get_fun=nullptr) = 0;
+
+    /// Write a full set of values (one per name) as a single update.
+    virtual void Publish(const emp::vector<double> & new_values) = 0;
+
+    /// Segment names must begin with a single slash.
+    static std::string ToSegmentName(const std::string & name) {
+      return (name.size() && name[0] == '/') ? name : "/" + name;
+    }
+
+    /// Function used to build new exports (null if no implementation has been included).
+    static factory_t & Factory() { static factory_t factory = nullptr; return factory; }
+
+    /// Build a new export, or return null if none is available in this program.
+    static std::shared_ptr<SharedExportBase> Make(const std::string & name) {
+      return Factory() ? Factory()(name) : nullptr;
+    }
+  };
+
+}
+
+#endif
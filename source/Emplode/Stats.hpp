@@ -0,0 +1,146 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Stats.hpp
+ *  @brief Summary statistics over contiguous arrays of values.
+ *  @note Status: BETA
+ *
+ *  Moments are accumulated in a single pass with Welford's updates (and the matching
+ *  co-moment update for correlation), which avoid the cancellation problems of summing
+ *  squares.  Quantiles use selection (std::nth_element) rather than a full sort.
+ *
+ *  Variances are POPULATION variances (divided by N, not N-1).  Quantiles interpolate
+ *  linearly between the two nearest ranks (the default method in R and NumPy).
+ */
+
+#ifndef EMPLODE_STATS_HPP
+#define EMPLODE_STATS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/vector.hpp"
+
+namespace emplode {
+namespace Stats {
+
+  static constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+  /// Strict ordering that places NaNs after every number (so sorting stays well defined).
+  inline bool LessNaNLast(double x, double y) { return x < y || (!std::isnan(x) && std::isnan(y)); }
+
+  /// Single-pass mean and variance accumulator.
+  class RunningStats {
+  private:
+    size_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;     ///< Sum of squared differences from the current mean.
+
+  public:
+    void Add(double x) {
+      ++count;
+      const double delta = x - mean;
+      mean += delta / count;
+      m2 += delta * (x - mean);
+    }
+
+    size_t GetCount() const { return count; }
+    double GetMean() const { return count ? mean : NaN; }
+    double GetVariance() const { return count ? m2 / count : NaN; }
+    double GetStdDev() const { return std::sqrt(GetVariance()); }
+  };
+
+  inline RunningStats Summarize(std::span<const double> values) {
+    RunningStats stats;
+    for (double x : values) stats.Add(x);
+    return stats;
+  }
+
+  inline double Mean(std::span<const double> values) { return Summarize(values).GetMean(); }
+  inline double Variance(std::span<const double> values) { return Summarize(values).GetVariance(); }
+  inline double StdDev(std::span<const double> values) { return Summarize(values).GetStdDev(); }
+
+  /// Value at fraction q (0.0 to 1.0) through the values.  Reorders its input.
+  inline double Quantile(std::span<double> values, double q) {
+    if (values.empty() || std::isnan(q)) return NaN;
+    q = std::clamp(q, 0.0, 1.0);
+    const double pos = q * (values.size() - 1);
+    const size_t low_id = static_cast<size_t>(pos);
+    const double frac = pos - low_id;
+
+    std::nth_element(values.begin(), values.begin() + low_id, values.end(), LessNaNLast);
+    const double low = values[low_id];
+    if (frac == 0.0) return low;
+
+    // Everything past low_id is at least as large; the next rank is their minimum.
+    const double high = *std::min_element(values.begin() + low_id + 1, values.end(), LessNaNLast);
+    return low + frac * (high - low);
+  }
+
+  /// Median of the values.  Reorders its input.
+  inline double Median(std::span<double> values) { return Quantile(values, 0.5); }
+
+  /// Count values into num_bins equal-width bins across [min, max]; the last bin includes
+  /// max and values outside the range are skipped.
+  inline emp::vector<double> Histogram(std::span<const double> values, size_t num_bins,
+                                       double min, double max) {
+    emp::vector<double> counts(num_bins, 0.0);
+    if (num_bins == 0 || !(min <= max)) return counts;
+    const double scale = (max > min) ? num_bins / (max - min) : 0.0;
+    for (double x : values) {
+      if (!(x >= min && x <= max)) continue;
+      const size_t bin = std::min(static_cast<size_t>((x - min) * scale), num_bins - 1);
+      counts[bin] += 1.0;
+    }
+    return counts;
+  }
+
+  /// Histogram across the full range of the values.
+  inline emp::vector<double> Histogram(std::span<const double> values, size_t num_bins) {
+    if (values.empty()) return emp::vector<double>(num_bins, 0.0);
+    const auto [min_it, max_it] = std::minmax_element(values.begin(), values.end());
+    return Histogram(values, num_bins, *min_it, *max_it);
+  }
+
+  /// Shannon entropy (in bits) of the distribution of distinct values.  Reorders its input.
+  inline double Entropy(std::span<double> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end(), LessNaNLast);
+    const double total = static_cast<double>(values.size());
+    double entropy = 0.0;
+    size_t run_start = 0;
+    for (size_t i = 1; i <= values.size(); ++i) {
+      if (i < values.size() && values[i] == values[run_start]) continue;
+      const double p = (i - run_start) / total;
+      entropy -= p * std::log2(p);
+      run_start = i;
+    }
+    return entropy;
+  }
+
+  /// Pearson correlation between two equal-length series, computed in a single pass.
+  inline double Correlation(std::span<const double> x, std::span<const double> y) {
+    emp_assert(x.size() == y.size(), x.size(), y.size());
+    double mean_x = 0.0, mean_y = 0.0, m2_x = 0.0, m2_y = 0.0, co_moment = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      const double n = static_cast<double>(i + 1);
+      const double dx = x[i] - mean_x;
+      const double dy = y[i] - mean_y;
+      mean_x += dx / n;
+      mean_y += dy / n;
+      m2_x += dx * (x[i] - mean_x);
+      m2_y += dy * (y[i] - mean_y);
+      co_moment += dx * (y[i] - mean_y);
+    }
+    return co_moment / std::sqrt(m2_x * m2_y);
+  }
+
+}
+}
+
+#endif
@@ -12,16 +12,20 @@
  *  variables), Symbol_Function and Symbol_Scope, all defined in their own files
  *  and derived from Symbol.
  * 
+ *  To keep symbols small (most are short-lived temporaries), a symbol holds only a pointer to
+ *  its name, which is null for unnamed symbols.  Descriptions and other rarely used metadata
+ *  (format and range) are kept in a separate block owned by the symbol, which is only
+ *  allocated once one of them is set; temporaries never have one.
+ *
  *  Development Notes:
  *  - Currently we are not using Format; this would be useful if we want to type-check inputs more
  *    carefully.
- *  - When a Symbol is used for a temporary value, it doesn't actually need name or desc;
- *    we can probably remove these pretty easily to save on memory if needed.
  */
 
 #ifndef EMPLODE_SYMBOL_HPP
 #define EMPLODE_SYMBOL_HPP
 
+#include <string>
 #include <type_traits>
 
 #include "emp/base/assert.hpp"
@@ -43,32 +47,68 @@ namespace emplode {
   class Symbol_Scope;
   class TypeInfo;
 
+  /// Can a pointer to an EmplodeType be converted to T with a static cast?  (Not if T derives
+  /// from EmplodeType virtually.)
+  template <typename T>
+  constexpr bool IsStaticObjectCast() {
+    return requires (EmplodeType * ptr) { static_cast<T *>(ptr); };
+  }
+
   class Symbol {
   protected:
-    std::string name;             ///< Unique name for symbol; empty name implies temporary.
-    std::string desc;             ///< Description to put in comments for this symbol.
-    emp::Ptr<Symbol_Scope> scope; ///< Which scope was this variable defined in?
-
-    bool is_temporary = false;    ///< Is this Symbol temporary and should be deleted?
-    bool is_builtin = false;      ///< Built-in entries should not be written to config files.
-  
     enum class Format { NONE=0, SCOPE,
                         BOOL, INT, UNSIGNED, DOUBLE,                                    // Values
                         STRING, FILENAME, PATH, URL, ALPHABETIC, ALPHANUMERIC, NUMERIC  // Strings
                       };
-    Format format = Format::NONE;
 
-    // If we know the constraints on this parameter we can perform better error checking.
-    emp::Range<double> range;  ///< Min and max values allowed for this config entry (if numerical).
-    bool integer_only=false;   ///< Should we only allow integer values?
+    /// Rarely used information about a symbol, kept out of line.
+    struct Metadata {
+      std::string desc;          ///< Description to put in comments for this symbol.
+      Format format = Format::NONE;
+
+      // If we know the constraints on this parameter we can perform better error checking.
+      emp::Range<double> range;  ///< Min and max values allowed for this config entry (if numerical).
+      bool integer_only=false;   ///< Should we only allow integer values?
+    };
+
+    emp::Ptr<std::string> name = nullptr;  ///< Name for symbol; null implies unnamed (temporary).
+    emp::Ptr<Metadata> metadata = nullptr; ///< Owned metadata; null until any is set.
+    emp::Ptr<Symbol_Scope> scope;          ///< Which scope was this variable defined in?
+
+    bool is_temporary = false;    ///< Is this Symbol temporary and should be deleted?
+    bool is_builtin = false;      ///< Built-in entries should not be written to config files.
 
     using symbol_ptr_t = emp::Ptr<Symbol>;
 
     // Helper functions.
 
+    /// Access this symbol's metadata, creating it if needed.
+    Metadata & EditMetadata() {
+      if (!metadata) metadata = emp::NewPtr<Metadata>();
+      return *metadata;
+    }
+
+    void ClearMetadata() {
+      if (metadata) metadata.Delete();
+      metadata = nullptr;
+    }
+
+    void SetNameImpl(const std::string & in) {
+      if (name) name.Delete();
+      name = in.size() ? emp::NewPtr<std::string>(in) : nullptr;
+    }
+
+    void CopyInfo(const Symbol & in) {
+      SetNameImpl(in.GetName());
+      if (in.metadata) EditMetadata() = *in.metadata;
+      else ClearMetadata();
+    }
+
     /// Write out the provided description at the comment_offset.  The start_pos is where the
     /// text currently is.   For multi-line comments, make sure to indent properly.
     void WriteDesc(std::ostream & os, size_t comment_offset, size_t start_pos) const {
+      const std::string & desc = GetDesc();
+
       // If there is no description, provide a newline and stop.
       if (desc.size() == 0) {
         std::cout << '\n';
@@ -90,16 +130,41 @@ namespace emplode {
     Symbol(const std::string & _name,
                 const std::string & _desc,
                 emp::Ptr<Symbol_Scope> _scope)
-      : name(_name), desc(_desc), scope(_scope) { }
-    Symbol(const Symbol &) = default;
-    virtual ~Symbol() { }
+      : scope(_scope)
+    {
+      SetNameImpl(_name);
+      if (_desc.size()) EditMetadata().desc = _desc;
+    }
+    Symbol(const Symbol & in)
+      : scope(in.scope), is_temporary(in.is_temporary), is_builtin(in.is_builtin)
+    {
+      CopyInfo(in);
+    }
+    virtual ~Symbol() {
+      if (name) name.Delete();
+      ClearMetadata();
+    }
+
+    Symbol & operator=(const Symbol & in) {
+      if (&in == this) return *this;
+      CopyInfo(in);
+      scope = in.scope;
+      is_temporary = in.is_temporary;
+      is_builtin = in.is_builtin;
+      return *this;
+    }
+
+    static const std::string & EmptyString() {
+      static const std::string empty;
+      return empty;
+    }
 
-    const std::string & GetName() const noexcept { return name; }
-    const std::string & GetDesc() const noexcept { return desc; }
+    const std::string & GetName() const noexcept { return name ? *name : EmptyString(); }
+    const std::string & GetDesc() const { return metadata ? metadata->desc : EmptyString(); }
     emp::Ptr<Symbol_Scope> GetScope() { return scope; }
     bool IsTemporary() const noexcept { return is_temporary; }
     bool IsBuiltin() const noexcept { return is_builtin; }
-    Format GetFormat() const noexcept { return format; }
+    Format GetFormat() const { return metadata ? metadata->format : Format::NONE; }
 
     virtual std::string GetTypename() const = 0;       ///< Derived classes must provide type info.
 
@@ -109,8 +174,10 @@ namespace emplode {
 
     virtual bool IsError() const { return false; }     ///< Does symbol flag an error?
     virtual bool IsFunction() const { return false; }  ///< Is symbol a function?
+    virtual bool IsPure() const { return false; }      ///< Is symbol a side-effect-free function?
     virtual bool IsObject() const { return false; }    ///< Is symbol associated with C++ object?
     virtual bool IsScope() const { return false; }     ///< Is symbol a full scope?
+    virtual bool IsList() const { return false; }      ///< Is symbol a list of values?
 
     virtual bool IsInterrupt() const { return false; } ///< Is symbol an interrupt signal that should be propagated outwards?
     virtual bool IsReturn() const { return false; }    ///< Is symbol a "return" signal?
@@ -122,8 +189,11 @@ namespace emplode {
     virtual bool HasNumericReturn() const { return false; } ///< Is symbol a function that returns a number?
     virtual bool HasStringReturn() const { return false; }  ///< Is symbol a function that returns a string?
 
-    Symbol & SetName(const std::string & in) { name = in; return *this; }
-    Symbol & SetDesc(const std::string & in) { desc = in; return *this; }
+    Symbol & SetName(const std::string & in) { SetNameImpl(in); return *this; }
+    Symbol & SetDesc(const std::string & in) {
+      if (in.size() || metadata) EditMetadata().desc = in;
+      return *this;
+    }
     Symbol & SetTemporary(bool in=true) { is_temporary = in; return *this; }
     Symbol & SetBuiltin(bool in=true) { is_builtin = in; return *this; }
 
@@ -204,7 +274,15 @@ namespace emplode {
         emp::Ptr<EmplodeType> obj_ptr = GetObjectPtr();
         // If have an object, see what we can convert it to.
         if (obj_ptr){
-          // First, check if this is already the correct type.
+          // Objects nearly always have exactly the type recorded in their TypeInfo, which can
+          // be checked by TypeID; a static cast then suffices.
+          if constexpr (IsStaticObjectCast<decay_T>()) {
+            if (HasObjectType(emp::GetTypeID<decay_T>())) {
+              return *static_cast<decay_T *>(obj_ptr.Raw());
+            }
+          }
+
+          // Otherwise, check if this is already the correct type (such as a base class).
           emp::Ptr<decay_T> typed_obj_ptr = obj_ptr.DynamicCast<decay_T>();
 
           // If not, check if we can substitute it for another type.
@@ -242,8 +320,8 @@ namespace emplode {
       }
     }
 
-    Symbol & SetMin(double min) { range.SetLower(min); return *this; }
-    Symbol & SetMax(double max) { range.SetUpper(max); return *this; }
+    Symbol & SetMin(double min) { EditMetadata().range.SetLower(min); return *this; }
+    Symbol & SetMax(double max) { EditMetadata().range.SetUpper(max); return *this; }
 
     // Try to copy another config symbol into this one; return true if successful.
     virtual bool CopyValue(const Symbol & ) { return false; }
@@ -274,8 +352,8 @@ namespace emplode {
 
       // Setup this symbol.
       std::string cur_line = prefix;
-      if (IsLocal()) cur_line += emp::to_string(GetTypename(), " ", name, " = ");
-      else cur_line += emp::to_string(name, " = ");
+      if (IsLocal()) cur_line += emp::to_string(GetTypename(), " ", GetName(), " = ");
+      else cur_line += emp::to_string(GetName(), " = ");
 
       // Print the current value of this variable; if it's a string make sure to turn it to a literal.
       cur_line += IsString() ? emp::to_literal(AsString()) : AsString();
@@ -303,6 +381,7 @@ namespace emplode {
       if (IsFunction()) out += " Function";
       if (IsObject()) out += " Object";
       if (IsScope()) out += " Scope";
+      if (IsList()) out += " List";
       if (IsLocal()) out += " Local";
       if (IsFunction()) out += " Function";
       if (HasNumericReturn()) out += " (numeric return)";
@@ -330,9 +409,9 @@ namespace emplode {
       : Symbol(_n, _d, _s), value(_v.value) {}
 
     Symbol_Var(const Symbol_Var &) = default;
-    Symbol_Var(double _val)              : Symbol("__Auto__", "", nullptr), value(_val) {}
-    Symbol_Var(const std::string & _val) : Symbol("__Auto__", "", nullptr), value(_val) {}
-    Symbol_Var(const emp::Datum & _val)  : Symbol("__Auto__", "", nullptr), value(_val) {}
+    Symbol_Var(double _val)              : Symbol("", "", nullptr), value(_val) {}
+    Symbol_Var(const std::string & _val) : Symbol("", "", nullptr), value(_val) {}
+    Symbol_Var(const emp::Datum & _val)  : Symbol("", "", nullptr), value(_val) {}
 
     Symbol_Var & operator=(const Symbol_Var &) = default;
 
@@ -384,8 +463,16 @@ namespace emplode {
     std::string ToString() const { return ToString(type); }
 
   public:
+    /// A temporary return value is owned by this symbol (until taken).
     Symbol_Special(Type in_type, symbol_ptr_t return_value = nullptr)
       : Symbol("__Special", ToString(in_type), nullptr), type(in_type), return_value(return_value) {}
+    Symbol_Special(const Symbol_Special & in)
+      : Symbol(in), type(in.type), return_value(in.return_value) {
+      if (return_value && return_value->IsTemporary()) return_value = return_value->Clone();
+    }
+    ~Symbol_Special() {
+      if (return_value && return_value->IsTemporary()) return_value.Delete();
+    }
     std::string GetTypename() const override { return emp::to_string("[[Special::", ToString(), "]]"); }
 
     symbol_ptr_t Clone() const override { return emp::NewPtr<this_t>(*this); }
@@ -396,6 +483,13 @@ namespace emplode {
     bool IsBreak() const override { return type == BREAK; }  ///< Is symbol a "break" signal?
 
     symbol_ptr_t ReturnValue() const { return return_value; }
+
+    /// Hand the return value to the caller (who becomes responsible for a temporary).
+    symbol_ptr_t TakeReturnValue() {
+      symbol_ptr_t out = return_value;
+      return_value = nullptr;
+      return out;
+    }
   };
 
   /// A Symbol to transmit an error due to invalid parsing.
@@ -420,7 +514,7 @@ namespace emplode {
   //  Function definitions...
 
   emp::Ptr<Symbol> Symbol::Call( const emp::vector<symbol_ptr_t> & /* args */ ) {
-    return emp::NewPtr<Symbol_Error>("Cannot call a function on non-function '", name, "'.");
+    return emp::NewPtr<Symbol_Error>("Cannot call a function on non-function '", GetName(), "'.");
   }
 
 }
@@ -12,7 +12,7 @@
  * 
  *  Specifically, the symbol table keeps track of:
  *  - The global scope for the current run; all other non-anonymous scopes can be reached from here
- *     and symbols are stored inside of scopes.
+ *     and symbols are stored inside of scopes.  Its parent is the shared BuiltinLibrary scope.
  *  - The event manager for all events that can be triggered.
  *  - The current set of types available in Emplode
  *  - The current set of files (or streams) used by Emplode
@@ -36,7 +36,9 @@
 #include "emp/io/StreamManager.hpp"
 #include "emp/meta/TypeID.hpp"
 
+#include "BuiltinLibrary.hpp"
 #include "EventManager.hpp"
+#include "OutputPool.hpp"
 #include "Symbol_Scope.hpp"
 #include "SymbolTableBase.hpp"
 #include "Symbol_Object.hpp"
@@ -51,10 +53,12 @@ namespace emplode {
     std::unordered_map<std::string, emp::Ptr<TypeInfo>> type_map;   ///< Types, lookup by name.
     std::unordered_map<emp::TypeID, emp::Ptr<TypeInfo>> typeid_map; ///< Types, lookup by TypeID.
     emp::StreamManager file_map;                                    ///< File streams by name.
+    OutputPool output_pool;                                         ///< Pooled DataFile output.
 
   public:
     SymbolTable(const std::string & name)
-    : root_scope(name, "Global scope", nullptr, this), event_manager(*this) {
+    : root_scope(name, "Global scope", &BuiltinLibrary::Get().GetScope(), this)
+    , event_manager(*this) {
       // Initialize the type map.
       type_map["INVALID"] = emp::NewPtr<TypeInfo>( *this, 0, "/*ERROR*/", "Error, Invalid type!" );
       type_map["Void"] = emp::NewPtr<TypeInfo>( *this, 1, "Void", "Non-type variable; no value" );
@@ -70,6 +74,10 @@ namespace emplode {
     }
 
     ~SymbolTable() {
+      // Release events and symbols before types; owned objects are freed through their TypeInfo.
+      event_manager.Clear();
+      root_scope.Clear();
+
       // Clean up type information.
       for (auto [name, ptr] : type_map) ptr.Delete();
     }
@@ -77,6 +85,7 @@ namespace emplode {
     Symbol_Scope & GetRootScope() { return root_scope; }
     const Symbol_Scope & GetRootScope() const { return root_scope; }
     emp::StreamManager & GetFileManager() { return file_map; }
+    OutputPool & GetOutputPool() { return output_pool; }
 
     bool HasSignal(const std::string & name) const { return event_manager.HasSignal(name); }
     bool HasType(const std::string & name) const { return emp::Has(type_map, name); }
@@ -106,6 +115,18 @@ namespace emplode {
       root_scope.AddBuiltinFunction(name, emplode_fun, desc, return_id);
     }
 
+    /// Add a built-in function whose result depends only on its arguments (with no side
+    /// effects), so repeated calls may share a result.  If memo_size is non-zero, up to that
+    /// many recent results are also cached (see MemoCache.hpp).
+    template <typename FUN_T>
+    void AddPureFunction(const std::string & name, FUN_T fun, const std::string & desc,
+                         size_t memo_size=0) {
+      AddFunction(name, fun, desc);
+      emp::Ptr<Symbol_Function> fun_ptr = root_scope.GetSymbol(name)->GetValue()->AsFunctionPtr();
+      fun_ptr->SetPure();
+      fun_ptr->SetMemo(memo_size);
+    }
+
     /// To add a type, provide the type name (that can be referred to in a script) and a function
     /// that should be called (with the variable name) when an instance of that type is created.
     /// The function must return a reference to the newly created instance.
@@ -156,6 +177,30 @@ namespace emplode {
       return AddType<OBJECT_T>(type_name, desc, init_fun, copy_fun, true);
     }
 
+    /// Add a type whose objects are owned by Emplode and stored in a chunked ObjectPool, so that
+    /// they have stable addresses and can be created, destroyed, and iterated over cheaply.
+    template <typename OBJECT_T, size_t CHUNK_SIZE=256>
+    TypeInfo & AddPooledType(const std::string & type_name, const std::string & desc) {
+      auto pool = emp::NewPtr<ObjectPool<OBJECT_T, CHUNK_SIZE>>();
+      auto init_fun = [pool](const std::string & /*name*/){ return pool->New(); };
+      auto copy_fun = DefaultCopyFun<OBJECT_T>();
+      TypeInfo & info = AddType<OBJECT_T>(type_name, desc, init_fun, copy_fun, true);
+      info.SetPool(pool);
+      return info;
+    }
+
+    /// Get the pool that stores objects for a type added with AddPooledType(); CHUNK_SIZE must
+    /// match the one used when the type was added.
+    template <typename OBJECT_T, size_t CHUNK_SIZE=256>
+    ObjectPool<OBJECT_T, CHUNK_SIZE> & GetPool() {
+      emp_always_assert(HasTypeID(emp::GetTypeID<OBJECT_T>()), "Type not found in symbol table.");
+      emp::Ptr<ObjectPoolBase> pool = typeid_map[emp::GetTypeID<OBJECT_T>()]->GetPool();
+      emp_always_assert(pool, "Type is not pooled.");
+      auto typed_pool = pool.DynamicCast<ObjectPool<OBJECT_T, CHUNK_SIZE>>();
+      emp_always_assert(typed_pool, "GetPool() CHUNK_SIZE does not match AddPooledType().", CHUNK_SIZE);
+      return *typed_pool;
+    }
+
     /// Make a new Symbol_Object using the provided *TypeInfo*, variable name, and scope.
     Var MakeObjSymbol(
       TypeInfo & type_info,
@@ -200,7 +245,7 @@ namespace emplode {
 
       // Use the TypeInfo associated with the provided type name to build an instance.
       emp::Ptr<EmplodeType> new_obj = type_info.MakeObj("__Temp");
-      auto new_symbol = emp::NewPtr<Symbol_Object>("__Temp", "", nullptr, new_obj, type_info, true, this);
+      auto new_symbol = emp::NewPtr<Symbol_Object>("", "", nullptr, new_obj, type_info, true, this);
 
       new_symbol->SetTemporary();                              // Mark new symbol to be deleted.
       new_obj->Setup(*new_symbol);                             // Setup new object with its symbol.
@@ -210,20 +255,47 @@ namespace emplode {
     }
 
 
-    /// Create a new type of event that can be used in the scripting language.
-    bool AddSignal(const std::string & name, size_t num_params=0) {
+    /// Create a new type of event that can be used in the scripting language; scripts must
+    /// trigger it with num_params arguments (-1 = any number).
+    bool AddSignal(const std::string & name, int num_params=-1) {
       return event_manager.AddSignal(name, num_params);
     }
 
-    /// Add an instance of an event with an action that should be triggered.
-    bool AddAction(
+    size_t GetSignalID(const std::string & name) const { return event_manager.GetSignalID(name); }
+    int GetSignalParams(const std::string & name) const { return event_manager.GetNumParams(name); }
+
+    /// Should triggers for this signal be queued until DeliverTriggers() is called?
+    bool SetSignalDeferred(const std::string & name, bool deferred=true) {
+      return event_manager.SetDeferred(name, deferred);
+    }
+
+    /// Run the actions for all queued triggers of deferred signals.
+    void DeliverTriggers() { event_manager.DeliverTriggers(); }
+    size_t GetNumQueuedTriggers() const { return event_manager.GetNumQueued(); }
+
+    /// Limit the number of steps each action linked to a signal may take.
+    bool SetSignalStepLimit(const std::string & name, size_t step_limit) {
+      return event_manager.SetStepLimit(name, step_limit);
+    }
+
+    /// Add an instance of an event with an action that should be triggered; returns a handle
+    /// that can be used to remove the action.
+    size_t AddAction(
       const std::string & name,
       emp::vector< emp::Ptr<ASTNode> > params,
       emp::Ptr<ASTNode_Block> action,
-      size_t def_line
+      size_t def_line,
+      EventSchedule schedule={},
+      double priority=0.0,
+      emp::Ptr<ASTNode> guard=nullptr
     ) {
       action->SetSymbolTable(*this);
-      return event_manager.AddAction(name, params, action, def_line);
+      return event_manager.AddAction(name, params, action, def_line, schedule, priority, guard);
+    }
+
+    bool RemoveAction(size_t handle) { return event_manager.RemoveAction(handle); }
+    emp::vector<size_t> GetActionHandles(const std::string & name) const {
+      return event_manager.GetActionHandles(name);
     }
 
     /// Trigger all events of a type (ignoring trigger values)
@@ -232,6 +304,11 @@ namespace emplode {
       return event_manager.Trigger(signal_name, std::forward<ARG_Ts>(args)...);
     }
 
+    /// Trigger a signal from script code, using argument symbols that the caller still owns.
+    void TriggerSymbols(size_t signal_id, const emp::vector<emp::Ptr<Symbol>> & args) {
+      event_manager.TriggerSymbols(signal_id, args);
+    }
+
     /// Print all of the events to the provided stream.
     void PrintEvents(std::ostream & os) const { event_manager.Write(os); }
 
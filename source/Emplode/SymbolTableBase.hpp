@@ -26,9 +26,46 @@ namespace emplode {
 
   // A base class for symbol table to provide low-level access to functions.
   class SymbolTableBase {
+  protected:
+    // Execution budget: each top-level run (loading a file, executing a statement, or running
+    // an event action) may only take a limited number of steps (loop iterations and user
+    // function calls) before it is considered a runaway script and aborted.
+    static constexpr size_t NO_LIMIT = static_cast<size_t>(-1);
+    size_t step_limit = 0;           ///< Default steps allowed per run (0 = unlimited)
+    size_t run_limit = NO_LIMIT;     ///< Steps allowed in the current run.
+    size_t steps_left = NO_LIMIT;    ///< Steps remaining in the current run.
+    size_t run_depth = 0;            ///< How many nested runs are active?
+
   public:
     virtual ~SymbolTableBase() { }
 
+    void SetStepLimit(size_t in_limit) { step_limit = in_limit; }
+    size_t GetStepLimit() const { return step_limit; }
+    size_t GetStepsLeft() const { return steps_left; }
+
+    /// Begin a run of script code.  An outermost run gets a fresh budget (the provided limit,
+    /// or the default step limit if none is given); nested runs share the outer budget.
+    void BeginRun(size_t limit=0) {
+      if (run_depth++ > 0) return;
+      if (limit == 0) limit = step_limit;
+      run_limit = steps_left = (limit == 0) ? NO_LIMIT : limit;
+    }
+    void EndRun() { emp_assert(run_depth > 0); --run_depth; }
+
+    /// Use up a single step of the current run; return false if the budget is exhausted.
+    bool UseStep() {
+      if (steps_left == 0) return false;
+      --steps_left;
+      return true;
+    }
+
+    /// Report that the current run went over its execution budget and abort.
+    [[noreturn]] void BudgetExceeded(int line_id, const std::string & location) const {
+      std::cerr << "ERROR (line " << line_id << "): execution budget of " << run_limit
+                << " steps exceeded in " << location << "; aborting." << std::endl;
+      exit(1);
+    }
+
     using symbol_ptr_t = emp::Ptr<Symbol>;
     using symbol_vector_t = const emp::vector<symbol_ptr_t> &;
     using target_t = symbol_ptr_t( symbol_vector_t );
@@ -44,7 +81,7 @@ namespace emplode {
       if constexpr (std::is_base_of<EmplodeType, T>()) {
         return MakeTempObjSymbol(emp::GetTypeID<T>(), &value);
       } else {
-        auto out_symbol = emp::NewPtr<Symbol_Var>("__Temp", value, "", nullptr);
+        auto out_symbol = emp::NewPtr<Symbol_Var>("", value, "", nullptr);
         out_symbol->SetTemporary();
         return out_symbol;
       }
@@ -203,10 +240,14 @@ namespace emplode {
                       "PARAM_Ts must match the extra arguments in member function.");
 
         return [name=name,fun=fun,&st](EmplodeType & obj, symbol_vector_t args) -> decltype(auto) {
-          // Make sure the correct object type is used for first argument.
-          emp::Ptr<EmplodeType> obj_ptr(&obj);
-          auto typed_ptr = obj_ptr.DynamicCast<std::remove_reference_t<PARAM1_T>>();
-          emp_assert(typed_ptr, "Internal error: member function call on wrong object type!", name);
+          // Member functions are only attached to objects of their own type (see
+          // EmplodeType::Setup), so no dynamic cast is needed unless the base is virtual.
+          using object_t = std::remove_reference_t<PARAM1_T>;
+          emp::Ptr<object_t> typed_ptr;
+          if constexpr (IsStaticObjectCast<object_t>()) typed_ptr = static_cast<object_t *>(&obj);
+          else typed_ptr = emp::Ptr<EmplodeType>(&obj).DynamicCast<object_t>();
+          emp_assert(typed_ptr && typed_ptr == emp::Ptr<EmplodeType>(&obj).DynamicCast<object_t>(),
+                     "Internal error: member function call on wrong object type!", name);
 
           // If this member function takes no additional arguments just call it without any!
           if constexpr (sizeof...(PARAM_Ts) == 0) {
@@ -11,6 +11,9 @@
 #ifndef EMPLODE_SYMBOL_FUNCTION_HPP
 #define EMPLODE_SYMBOL_FUNCTION_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "AST.hpp"
@@ -20,6 +23,7 @@
 #include "emp/datastructs/tuple_utils.hpp"
 #include "emp/meta/ValPack.hpp"
 
+#include "MemoCache.hpp"
 #include "Symbol.hpp"
 #include "SymbolTableBase.hpp"
 
@@ -41,9 +45,14 @@ namespace emplode {
 
     emp::vector<FunInfo> overloads;  // Set of overload options for this function.
     emp::TypeID return_type;         // All overloads must share a return type.
+    bool is_pure = false;            // Do calls depend only on arguments, with no side effects?
+    std::shared_ptr<MemoCache> memo; // Results of earlier calls, if memoized (shared by copies).
 
     // size_t arg_count;
 
+  protected:
+    uint64_t def_id = 0;             // Identifies the user-defined body called (0 if none).
+
   public:
     Symbol_Function(const std::string & _name,
                     std_fun_t fun,
@@ -62,6 +71,24 @@ namespace emplode {
     std::string GetTypename() const override { return "[Symbol_Function]"; }
 
     bool IsFunction() const override { return true; }
+    bool IsPure() const override { return is_pure; }
+
+    /// Mark this function as pure so that repeated calls may share a result.
+    void SetPure(bool in=true) { is_pure = in; }
+
+    /// Keep the results of up to capacity recent calls (0 to stop); function must be pure.
+    void SetMemo(size_t capacity) {
+      emp_assert(is_pure || capacity == 0, "Only pure functions may be memoized.", GetName());
+      if (capacity == 0) memo.reset();
+      else if (memo) memo->SetCapacity(capacity);
+      else memo = std::make_shared<MemoCache>(capacity);
+    }
+    bool HasMemo() const { return static_cast<bool>(memo); }
+    emp::Ptr<MemoCache> GetMemo() { return memo.get(); }
+
+    /// Copies of a function (and functions assigned from it) share an ID; any redefinition
+    /// changes it.
+    uint64_t GetDefID() const { return def_id; }
     bool HasNumericReturn() const override { return return_type.IsArithmetic(); }
     bool HasStringReturn() const override { return return_type.IsType<std::string>(); }
 
@@ -80,12 +107,34 @@ namespace emplode {
 
       const Symbol_Function & in_fun = in.AsFunction();
       overloads = in_fun.overloads;
+      def_id = in_fun.def_id;
+      is_pure = in_fun.is_pure;
+      memo = in_fun.memo;
 
       return true;
     }
 
 
     symbol_ptr_t Call( const emp::vector<symbol_ptr_t> & args ) override {
+      if (memo) [[unlikely]] return CallMemo(args);
+      return CallOverload(args);
+    }
+
+  private:
+    symbol_ptr_t CallMemo( const emp::vector<symbol_ptr_t> & args ) {
+      std::string key;     // Local, since the call may recurse.
+      if (!MemoCache::MakeKey(args, key)) {
+        memo->AddBypass();
+        return CallOverload(args);
+      }
+      symbol_ptr_t result;
+      if (memo->Find(key, result)) return result;
+      result = CallOverload(args);
+      if (!result || !result->IsError()) memo->Store(key, result);
+      return result;
+    }
+
+    symbol_ptr_t CallOverload( const emp::vector<symbol_ptr_t> & args ) {
       emp_assert(overloads.size() > 0);
 
       // Find the correct overloads...
@@ -94,7 +143,7 @@ namespace emplode {
       }
 
       std::string msg =
-        emp::to_string("No overload for function '", name, "' that takes ", args.size(),
+        emp::to_string("No overload for function '", GetName(), "' that takes ", args.size(),
                        " arguments.\n...", overloads.size(), " options are:");
       for (const auto & x : overloads) {
         msg += emp::to_string (' ', x.num_params);
@@ -108,6 +157,14 @@ namespace emplode {
   private:
     emp::Ptr<Symbol_Scope> own_scope;
     emp::Ptr<ASTNode_Block> body;
+    emp::vector<Var> params;
+    uint64_t own_def_id;          // ID of the body here (def_id changes if reassigned).
+
+    /// Instances may parse on separate threads, so IDs come from a shared atomic counter.
+    static uint64_t NextDefID() {
+      static std::atomic<uint64_t> next_id{1};
+      return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
 
     static std_fun_t make_fun(emp::Ptr<ASTNode_Block> body, emp::vector<Var> &params) {
       return [body, params](const emp::vector<emp::Ptr<Symbol>> & args) {
@@ -115,20 +172,23 @@ namespace emplode {
             std::cerr << "Expected " << params.size() << " arguments but got " << args.size() << std::endl;
             exit(1);
           }
+          SymbolTableBase & symbol_table = body->GetSymbolTable();
+          if (!symbol_table.UseStep()) [[unlikely]] {
+            symbol_table.BudgetExceeded(body->GetLine(), "function call");
+          }
           for (int i = 0; i < args.size(); i++) {
             auto param = params[i];
             param.SetValue(args[i]->ShallowClone());
           }
 
-          auto result = body->Process();
+          Value result = body->Process();
           if (result && result->IsReturn()) {
-            auto ret = result.DynamicCast<Symbol_Special>()->ReturnValue();
+            auto ret = result.Get().DynamicCast<Symbol_Special>()->TakeReturnValue();
             // Avoid leaking pointers to local variables which could be deleted if this function runs again
             if (ret && !ret->IsTemporary()) {
               ret = ret->ShallowClone();
               ret->SetTemporary();
             }
-            result.Delete();
             return ret;
           } else {
             emp::Ptr<Symbol> ret = nullptr;
@@ -145,13 +205,22 @@ namespace emplode {
                     emp::Ptr<Symbol_Scope> _scope,
                     emp::TypeID _ret_type,
                     emp::Ptr<Symbol_Scope> own_scope)
-      : own_scope(own_scope), body(body),
-      Symbol_Function(_name, make_fun(body, params), _desc, _scope, params.size(), _ret_type) {}
+      : Symbol_Function(_name, make_fun(body, params), _desc, _scope, params.size(), _ret_type),
+        own_scope(own_scope), body(body), params(params), own_def_id(NextDefID())
+    {
+      def_id = own_def_id;
+    }
 
     ~Symbol_UserFunction() {
       own_scope.Delete();
       body.Delete();
     }
+
+    emp::Ptr<ASTNode_Block> GetBody() const { return body; }
+    const emp::vector<Var> & GetParams() const { return params; }
+
+    /// Is this function still running its own body (rather than one assigned to it)?
+    bool HasOwnBody() const { return def_id == own_def_id; }
   };
 
 }
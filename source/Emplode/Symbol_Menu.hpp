@@ -0,0 +1,168 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Symbol_Menu.hpp
+ *  @brief A setting that must be one of a fixed set of named options.
+ *  @note Status: BETA
+ *
+ *  A menu (see EmplodeType::LinkMenu()) links a C++ variable to a list of options, each with a
+ *  value and a name.  Scripts see the setting as the name of the current option; assigning a
+ *  name selects that option, and any other name is reported as an error immediately.
+ *
+ *  Option names are kept once in a MenuNames table, which finds a name with a perfect hash (a
+ *  seed chosen so that no two names share a slot), so lookups take a single string comparison.
+ *  The symbol remembers which option is selected, so reading the setting only has to confirm
+ *  that the C++ variable still holds that option's value.
+ */
+
+#ifndef EMPLODE_SYMBOL_MENU_HPP
+#define EMPLODE_SYMBOL_MENU_HPP
+
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "emp/base/assert.hpp"
+#include "emp/base/vector.hpp"
+
+#include "Symbol.hpp"
+
+namespace emplode {
+
+  /// Option names for a menu, found by a perfect hash.
+  class MenuNames {
+  private:
+    emp::vector<std::string> names;
+    emp::vector<int> slots;         ///< Option id for each hash slot (-1 if unused).
+    uint64_t seed = 0;
+    size_t mask = 0;
+
+    static uint64_t Hash(std::string_view name, uint64_t seed) {
+      uint64_t hash = 14695981039346656037ULL ^ (seed * 0x9E3779B97F4A7C15ULL);
+      for (char c : name) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+      }
+      return hash ^ (hash >> 29);
+    }
+
+    /// Try to place every name using the current seed and table size.
+    bool TryBuild() {
+      slots.assign(mask + 1, -1);
+      for (size_t id = 0; id < names.size(); ++id) {
+        int & slot = slots[Hash(names[id], seed) & mask];
+        if (slot != -1) return false;
+        slot = static_cast<int>(id);
+      }
+      return true;
+    }
+
+  public:
+    MenuNames(emp::vector<std::string> in_names) : names(std::move(in_names)) {
+      for (size_t i = 0; i < names.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+          if (names[i] != names[j]) continue;
+          std::cerr << "Error: menu option '" << names[i] << "' is listed more than once."
+                    << std::endl;
+          exit(1);
+        }
+      }
+
+      // Search for a seed that gives every name its own slot, growing the table if it is
+      // too crowded to find one quickly.
+      mask = std::bit_ceil(2 * names.size() + 1) - 1;
+      while (true) {
+        for (seed = 0; seed < 64; ++seed) if (TryBuild()) return;
+        mask = 2 * mask + 1;
+      }
+    }
+
+    size_t GetSize() const { return names.size(); }
+    const std::string & GetName(size_t id) const { return names[id]; }
+
+    /// Find the id of an option name; returns -1 if there is no such option.
+    int Find(std::string_view name) const {
+      const int id = slots[Hash(name, seed) & mask];
+      return (id >= 0 && names[id] == name) ? id : -1;
+    }
+
+    /// List all option names (for error messages).
+    std::string GetList() const {
+      std::string out;
+      for (const std::string & name : names) {
+        if (out.size()) out += ", ";
+        out += name;
+      }
+      return out;
+    }
+  };
+
+  /// Script view of a C++ variable that holds one of the values listed in a menu.
+  template <typename VAR_T>
+  class Symbol_Menu : public Symbol {
+  private:
+    VAR_T & var;
+    emp::vector<VAR_T> values;       ///< Value of each option.
+    MenuNames names;                 ///< Name of each option.
+    mutable size_t option_id = 0;    ///< Option last seen in var.
+
+    /// Find the option that var currently holds (or the number of options if none).
+    size_t GetOptionID() const {
+      if (option_id < values.size() && values[option_id] == var) return option_id;
+      for (size_t id = 0; id < values.size(); ++id) {
+        if (values[id] == var) return option_id = id;
+      }
+      return values.size();
+    }
+
+  public:
+    Symbol_Menu(const std::string & _name, const std::string & _desc,
+                emp::Ptr<Symbol_Scope> _scope, VAR_T & _var,
+                emp::vector<VAR_T> _values, emp::vector<std::string> _names)
+      : Symbol(_name, _desc, _scope), var(_var), values(std::move(_values)),
+        names(std::move(_names))
+    {
+      emp_assert(values.size() == names.GetSize());
+    }
+
+    std::string GetTypename() const override { return "Menu"; }
+
+    bool IsString() const override { return true; }
+    bool HasValue() const override { return true; }
+
+    /// Name of the selected option (or "UNKNOWN" if var holds a value not in the menu).
+    const std::string & GetOptionName() const {
+      static const std::string unknown("UNKNOWN");
+      const size_t id = GetOptionID();
+      return id < values.size() ? names.GetName(id) : unknown;
+    }
+
+    double AsDouble() const override { return emp::Datum(GetOptionName()).AsDouble(); }
+    std::string AsString() const override { return GetOptionName(); }
+
+    /// Select an option by name; any other name is an error.
+    void Select(std::string_view option) {
+      const int id = names.Find(option);
+      if (id < 0) {
+        std::cerr << "Error: '" << option << "' is not an option for '" << GetName()
+                  << "'; options are: " << names.GetList() << "." << std::endl;
+        exit(1);
+      }
+      option_id = static_cast<size_t>(id);
+      var = values[option_id];
+    }
+
+    Symbol & SetString(const std::string & in) override { Select(in); return *this; }
+    bool CopyValue(const Symbol & in) override { Select(in.AsString()); return true; }
+
+    /// Copies hold the name of the current option, rather than linking to var.
+    symbol_ptr_t Clone() const override { return emp::NewPtr<Symbol_Var>(GetOptionName()); }
+  };
+
+}
+
+#endif
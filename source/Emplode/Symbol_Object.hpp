@@ -40,7 +40,8 @@ namespace emplode {
       
     Symbol_Object(const Symbol_Object & in) = delete;
     Symbol_Object(Symbol_Object && in)
-      : Symbol_Scope(std::move(in)), obj_ptr(in.obj_ptr), obj_owned(in.obj_owned)
+      : Symbol_Scope(std::move(in)), obj_ptr(in.obj_ptr), type_info_ptr(in.type_info_ptr)
+      , obj_owned(in.obj_owned)
     {
       // Remove the object from the incoming symbol.
       in.obj_ptr = nullptr;    
@@ -49,7 +50,7 @@ namespace emplode {
 
     ~Symbol_Object() {
       // If this scope owns its object pointer, delete it now.
-      if (obj_owned) obj_ptr.Delete();
+      if (obj_owned) type_info_ptr->FreeObj(obj_ptr);
     }
 
     emp::Ptr<EmplodeType> GetObjectPtr() override { return obj_ptr; }  
@@ -68,6 +69,9 @@ namespace emplode {
       if (type_info_ptr.IsNull()) return emp::GetTypeID<void>();
       return type_info_ptr->GetTypeID();
     }
+    bool HasObjectType(emp::TypeID in_type) const override {
+      return type_info_ptr ? type_info_ptr->GetTypeID() == in_type : in_type == emp::GetTypeID<void>();
+    }
 
     std::string AsString() const override {
       if (obj_ptr) { return obj_ptr->ToString(); }
@@ -120,8 +124,9 @@ namespace emplode {
       return out;
     }
 
+    /// A shallow clone refers to the same object, so it must never take ownership of it.
     emp::Ptr<Symbol> ShallowClone() const override {
-      return emp::NewPtr<Symbol_Object>(GetName(), GetDesc(), nullptr, obj_ptr, *type_info_ptr, obj_owned, symbol_table);
+      return emp::NewPtr<Symbol_Object>(GetName(), GetDesc(), nullptr, obj_ptr, *type_info_ptr, false, symbol_table);
     }
   };
 
@@ -137,7 +142,7 @@ namespace emplode {
   }
 
   // AST node to create an object
-  emp::Ptr<Symbol> ASTNode_ClassInit::Process() {
+  Value ASTNode_ClassInit::Process() {
     #ifndef NDEBUG
     emp::notify::Verbose(
       "Emplode::AST",
@@ -17,6 +17,7 @@
 #include "AST.hpp"
 #include "emp/base/map.hpp"
 #include "emp/datastructs/map_utils.hpp"
+#include <memory>
 #include <optional>
 
 #include "Symbol.hpp"
@@ -116,6 +117,13 @@ namespace emplode {
       }
     }
 
+    /// Let the variables in this scope be copied from several threads at once (see
+    /// Var::SetShared()); the scope itself must no longer be changed.
+    void SetShared() { for (auto & [name, var] : symbol_map) var.SetShared(); }
+
+    /// Remove all symbols from this scope.
+    void Clear() { symbol_map.clear(); }
+
     /// Get a symbol out of this scope; 
     std::optional<Var> GetSymbol(std::string name) {
       auto result = symbol_map.find(name);
@@ -184,6 +192,22 @@ namespace emplode {
       return var;
     }
 
+    /// Add a configuration symbol that is kept outside of this scope (and shared with whoever
+    /// made it); assignments go through the symbol's CopyValue() rather than replacing it.
+    Var LinkSymbol(const std::string & name, std::shared_ptr<Symbol> symbol,
+                   bool is_builtin = false) {
+      emp_always_assert(!emp::Has(symbol_map, name), "Do not redeclare functions or variables!",
+                 name);
+      if (is_builtin) symbol->SetBuiltin();
+      auto entry = symbol_map.insert({name, Var([symbol]() {
+        return emp::Ptr<Symbol>(symbol.get());
+      }, [symbol](emp::Ptr<Symbol> value) {
+        symbol->CopyValue(*value);
+        value.Delete();   // The Var owns the incoming value, but we only needed its contents.
+      })});
+      return entry.first->second;
+    }
+
     /// Add an internal variable of type String.
     Var AddLocalVar(const std::string & name, const std::string & desc) {
       return Add<Symbol_Var>(name, 0.0, desc, this);
@@ -225,6 +249,13 @@ namespace emplode {
       return Add<Symbol_Function>(name, fun, desc, this, CountParams<FUN_T>(), return_type);
     }
 
+    /// Add a new function, providing number of params separately (-1 for any number).
+    template <typename FUN_T>
+    Var AddFunction(const std::string & name,  FUN_T fun,  const std::string & desc,
+                    emp::TypeID return_type,  int num_params) {
+      return Add<Symbol_Function>(name, fun, desc, this, num_params, return_type);
+    }
+
     /// Add a new user-defined function, providing number of params separately.
     Var AddUserFunction(const std::string & name, const std::string & desc,
                                   emp::TypeID return_type, emp::vector<Var> params,
@@ -262,7 +293,7 @@ namespace emplode {
       // Declare this scope, starting with the type if originally declared locally.
       std::string cur_line = prefix;
       if (IsLocal()) cur_line += emp::to_string(GetTypename(), " ");
-      cur_line += name;
+      cur_line += GetName();
 
       bool has_body = emp::AnyOf(symbol_map, [](Var var){ return !var.GetValue()->IsBuiltin(); });
 
@@ -284,7 +315,7 @@ namespace emplode {
 
     /// Make a copy of this scope and all of the entries inside it.
     symbol_ptr_t Clone() const override {
-      emp::Ptr<Symbol_Scope> result = emp::NewPtr<Symbol_Scope>(name, desc, scope);
+      emp::Ptr<Symbol_Scope> result = emp::NewPtr<Symbol_Scope>(GetName(), GetDesc(), scope);
       for (auto [name, var] : symbol_map) {
         result->symbol_map.insert({name, Var(var.GetValue()->Clone())});
       }
@@ -313,9 +344,8 @@ namespace emplode {
       member_funs->AddBuiltinFunction(name, wrapped, desc, ret_type);
     }
 
-  public:
-    Symbol_List() : Symbol("__List", "List", nullptr) {
-      values = std::make_shared<emp::vector<symbol_ptr_t>>();
+    /// Member functions are only set up once they are first accessed.
+    void SetupMemberFuns() {
       member_funs.New("List", "List scope", nullptr, nullptr);
       AddMemberFun<1>("push", "Add a value to the end of the list", emp::GetTypeID<void>(), [this](symbol_ptr_t value) {
         if (!value->IsTemporary()) {
@@ -333,18 +363,25 @@ namespace emplode {
       });
     }
 
+  public:
+    Symbol_List() : Symbol("", "", nullptr) {
+      values = std::make_shared<emp::vector<symbol_ptr_t>>();
+    }
+
     ~Symbol_List() {
       if (values.use_count() == 1) {
         for (auto i : *values) {
           i.Delete();
         }
       }
-      member_funs.Delete();
+      if (member_funs) member_funs.Delete();
     }
 
     std::string GetTypename() const override { return "List"; }
+    bool IsList() const override { return true; }
 
     emp::Ptr<Symbol_Scope> AsScopePtr() override {
+      if (!member_funs) SetupMemberFuns();
       return member_funs;
     }
 
@@ -367,6 +404,9 @@ namespace emplode {
       values->push_back(value);
     }
 
+    size_t GetSize() const { return values->size(); }
+    const emp::vector<symbol_ptr_t> & GetValues() const { return *values; }
+
     LValue Get(size_t idx) {
       if (idx >= values->size()) {
         std::cerr << "index " << idx << " out of bounds for list of length " << values->size() << std::endl;
@@ -390,7 +430,7 @@ namespace emplode {
   };
 
   // These has to be here (or in another downstream file) because of include cycle issues
-  emp::Ptr<Symbol> ASTNode_ListInit::Process() {
+  Value ASTNode_ListInit::Process() {
     #ifndef NDEBUG
     emp::notify::Verbose(
       "Emplode::AST",
@@ -400,7 +440,7 @@ namespace emplode {
     auto list = emp::NewPtr<Symbol_List>();
     list->SetTemporary();
     for (auto i : children) {
-      symbol_ptr_t value = i->Process();
+      Value value = i->Process();
       if (!value) {
         std::cerr << "Expression in list initializer does not produce a value" << std::endl;
         exit(1);
@@ -408,14 +448,11 @@ namespace emplode {
       auto clone = value->ShallowClone();
       clone->SetTemporary(false);
       list->Push(clone);
-      if (value->IsTemporary()) {
-        value.Delete();
-      }
     }
     return list;
   }
 
-  emp::Ptr<Symbol> ASTNode_StructInit::Process() {
+  Value ASTNode_StructInit::Process() {
     #ifndef NDEBUG
     emp::notify::Verbose(
       "Emplode::AST",
@@ -427,7 +464,7 @@ namespace emplode {
     return scope;
   }
 
-  emp::Ptr<Symbol> ASTNode_CopyFields::Process() {
+  Value ASTNode_CopyFields::Process() {
     #ifndef NDEBUG
     emp::notify::Verbose(
       "Emplode::AST",
@@ -435,8 +472,8 @@ namespace emplode {
     );
     #endif
     emp_assert(children.size() == 2);
-    symbol_ptr_t lhs = children[0]->Process();
-    symbol_ptr_t rhs = children[1]->Process();
+    Value lhs = children[0]->Process();
+    Value rhs = children[1]->Process();
     auto lhs_scope = lhs->AsScopePtr();
     auto rhs_scope = rhs->AsScopePtr();
     if (!lhs_scope || !rhs_scope) {
@@ -444,16 +481,18 @@ namespace emplode {
       exit(1);
     }
     lhs_scope->CopyFields(*rhs_scope);
-    // Rhs might be temporary and should be deleted, but lhs is the target and should never be temporary
-    if (rhs->IsTemporary())
-      rhs.Delete();
     return nullptr;
   }
 
+  ASTNode_For::~ASTNode_For() {
+    scope.Delete();
+  }
+
   std::optional<LValue> ASTNode_Member::AsLValue() {
     emp_assert(children.size() == 1);
 
-    auto scope = children[0]->Process()->AsScopePtr();
+    Value base = children[0]->Process();
+    auto scope = base->AsScopePtr();
     if (!scope) {
       std::cerr << "tried to access member of non-scope:" << std::endl;
       PrintAST(std::cerr);
@@ -461,10 +500,11 @@ namespace emplode {
     }
     // In C++23 this would use and_then()
     auto var = scope->GetSymbol(name);
-    if (var.has_value())
-      return LValue(*var);
-    else
-      return {};
+    if (!var.has_value()) return {};
+    // Members of a temporary (such as a list's member functions) refer back to it.
+    LValue out(*var);
+    out.SetBase(std::move(base));
+    return out;
   }
 
   std::optional<LValue> ASTNode_Subscript::AsLValue() {
@@ -477,21 +517,24 @@ namespace emplode {
 
     emp_assert(children.size() == 2);
 
-    auto list = children[0]->Process().DynamicCast<Symbol_List>();
+    Value base = children[0]->Process();
+    auto list = base.Get().DynamicCast<Symbol_List>();
     if (!list) {
       std::cerr << "tried to use subscript on non-list:" << std::endl;
       PrintAST(std::cerr);
       exit(1);
     }
 
-    auto idx = children[1]->Process()->AsDouble();
+    auto idx = children[1]->ProcessAs<double>();
     if (size_t(idx) != idx) {
       std::cerr << "tried to use subscript with negative or non-integer index " << idx << std::endl;
       PrintAST(std::cerr);
       exit(1);
     }
 
-    return list->Get(idx);
+    LValue out = list->Get(idx);
+    out.SetBase(std::move(base));
+    return out;
   }
 }
 #endif
@@ -0,0 +1,102 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ThreadPool.hpp
+ *  @brief A small fixed-size pool of worker threads for running independent tasks.
+ *  @note Status: BETA
+ *
+ *  The pool runs one batch at a time: ParallelFor(n, fun) calls fun(0) ... fun(n-1), spread
+ *  across the workers and the calling thread, and returns once every call has finished.
+ *  Workers sleep between batches, so an idle pool costs nothing.
+ */
+
+#ifndef EMPLODE_THREAD_POOL_HPP
+#define EMPLODE_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "emp/base/vector.hpp"
+
+namespace emplode {
+
+  class ThreadPool {
+  private:
+    emp::vector<std::thread> workers;
+    std::mutex batch_mutex;              ///< Only one batch may run at a time.
+    std::mutex mutex;                    ///< Protects the batch state below.
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+
+    std::function<void(size_t)> task;    ///< Current batch task.
+    size_t num_tasks = 0;
+    std::atomic<size_t> next_task{0};
+    size_t batch_id = 0;                 ///< Incremented for each new batch.
+    size_t num_busy = 0;                 ///< Workers still running the current batch.
+    bool stopping = false;
+
+    void RunTasks() {
+      for (size_t id = next_task++; id < num_tasks; id = next_task++) task(id);
+    }
+
+    void WorkerLoop() {
+      size_t last_batch = 0;
+      while (true) {
+        {
+          std::unique_lock lock(mutex);
+          start_cv.wait(lock, [this,last_batch]{ return stopping || batch_id != last_batch; });
+          if (stopping) return;
+          last_batch = batch_id;
+        }
+        RunTasks();
+        std::lock_guard lock(mutex);
+        if (--num_busy == 0) done_cv.notify_one();
+      }
+    }
+
+  public:
+    /// Create a pool that runs batches on num_threads threads in total (including the caller).
+    ThreadPool(size_t num_threads) {
+      for (size_t i = 1; i < num_threads; ++i) workers.emplace_back([this]{ WorkerLoop(); });
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+      {
+        std::lock_guard lock(mutex);
+        stopping = true;
+      }
+      start_cv.notify_all();
+      for (auto & worker : workers) worker.join();
+    }
+
+    size_t GetNumThreads() const { return workers.size() + 1; }
+
+    /// Call fun(i) for every i in [0, n), in parallel; returns when all calls are done.
+    void ParallelFor(size_t n, std::function<void(size_t)> fun) {
+      std::lock_guard batch_lock(batch_mutex);
+      {
+        std::lock_guard lock(mutex);
+        task = std::move(fun);
+        num_tasks = n;
+        next_task = 0;
+        num_busy = workers.size();
+        ++batch_id;
+      }
+      start_cv.notify_all();
+      RunTasks();
+
+      std::unique_lock lock(mutex);
+      done_cv.wait(lock, [this]{ return num_busy == 0; });
+    }
+  };
+
+}
+
+#endif
@@ -12,11 +12,14 @@
 #define EMPLODE_TYPE_INFO_HPP
 
 #include <fstream>
+#include <tuple>
 
 #include "emp/base/assert.hpp"
 #include "emp/meta/TypeID.hpp"
 #include "emp/tools/string_utils.hpp"
 
+#include "MemberTable.hpp"
+#include "ObjectPool.hpp"
 #include "Symbol.hpp"
 #include "SymbolTableBase.hpp"
 
@@ -26,15 +29,25 @@ namespace emplode {
   struct MemberFunInfo {
     using symbol_ptr_t = emp::Ptr<Symbol>;
     using fun_t = std::function<symbol_ptr_t(EmplodeType &, const emp::vector<symbol_ptr_t> &)>;
+    using trampoline_t = symbol_ptr_t (*)(EmplodeType &, const emp::vector<symbol_ptr_t> &,
+                                          SymbolTableBase &);
 
     std::string name;
     std::string desc;
-    fun_t fun;
+    fun_t fun;                              // Wrapped function (if added individually)...
+    trampoline_t trampoline = nullptr;      // ...or trampoline (if added from a member table).
+    emp::Ptr<SymbolTableBase> symbol_table = nullptr;  // Needed by trampoline.
+    int num_params = -1;                    // Arguments expected (-1 = any, checked by fun)
     emp::TypeID return_type;
 
     MemberFunInfo(const std::string & in_name, const std::string & in_desc,
                   fun_t in_fun, emp::TypeID in_rtype)
       : name(in_name), desc(in_desc), fun(in_fun), return_type(in_rtype) {}
+    MemberFunInfo(const std::string & in_name, const std::string & in_desc,
+                  trampoline_t in_trampoline, SymbolTableBase & in_st, int in_params,
+                  emp::TypeID in_rtype)
+      : name(in_name), desc(in_desc), trampoline(in_trampoline), symbol_table(&in_st),
+        num_params(in_params), return_type(in_rtype) {}
   };
 
   // TypeInfo tracks a particular type to be used in the configuration langauge.
@@ -53,6 +66,7 @@ namespace emplode {
     init_fun_t init_fun;
     copy_fun_t copy_fun;
     bool config_owned = false; // Should objects of this type be managed by Emplode?
+    emp::Ptr<ObjectPoolBase> pool = nullptr; // Pooled storage for objects (if used); owned.
 
     emp::vector< MemberFunInfo > member_funs;
 
@@ -73,12 +87,20 @@ namespace emplode {
       emp_assert(type_name != "");
     }
 
+    ~TypeInfo() { if (pool) pool.Delete(); }
+
     size_t GetIndex() const { return index; }
     const std::string & GetTypeName() const { return type_name; }
     const std::string & GetDesc() const { return desc; }
     emp::TypeID GetTypeID() const { return type_id; }
     bool GetOwned() const { return config_owned; }
     const emp::vector<MemberFunInfo> & GetMemberFunctions() const { return member_funs; }
+    emp::Ptr<const MemberFunInfo> GetMemberFunction(const std::string & name) const {
+      for (const MemberFunInfo & info : member_funs) if (info.name == name) return &info;
+      return nullptr;
+    }
+    bool IsPooled() const { return !pool.IsNull(); }
+    emp::Ptr<ObjectPoolBase> GetPool() { return pool; }
 
     emp::Ptr<EmplodeType> MakeObj(const std::string & name="__temp__") const {
       emp_assert(init_fun, "No initialization function exists for type.", type_name);
@@ -89,6 +111,20 @@ namespace emplode {
       return false;
     }
 
+    /// Release an object that Emplode owns; pooled objects go back to their pool.
+    void FreeObj(emp::Ptr<EmplodeType> obj_ptr) const {
+      if (pool) pool->FreeObject(obj_ptr);
+      else obj_ptr.Delete();
+    }
+
+    /// Store objects of this type in the provided pool (which this TypeInfo takes ownership of);
+    /// new objects will be built by the pool unless an init function was already provided.
+    void SetPool(emp::Ptr<ObjectPoolBase> in_pool) {
+      emp_assert(!pool, "Type already has an object pool.", type_name);
+      pool = in_pool;
+      if (!init_fun) init_fun = [in_pool](const std::string & /*name*/){ return in_pool->NewObject(); };
+    }
+
     // Link this TypeInfo object to a real C++ type.
     // @CAO It would be nice to test to make sure this is an EmplodeType, but not possible with a TypeID.
     void LinkType(emp::TypeID in_id) { type_id = in_id; }
@@ -112,6 +148,24 @@ namespace emplode {
       using return_t = typename emp::FunInfo<FUN_T>::return_t;
       member_funs.emplace_back(name, desc, member_fun, emp::GetTypeID<return_t>());
     }
+
+    // Add a member function from a compile-time table entry (see MemberTable.hpp).
+    template <auto FUN>
+    void AddMember(const MemberFun<FUN> & entry) {
+      using helper_t = MemberTrampoline<FUN>;
+      emp_assert( type_id.IsType<typename helper_t::object_t>(),
+                  "Member function table entry must match class type!", entry.name, type_id );
+      member_funs.emplace_back(std::string(entry.name), std::string(entry.desc),
+                               &helper_t::Call, symbol_table, helper_t::NUM_PARAMS,
+                               emp::GetTypeID<typename helper_t::return_t>());
+    }
+
+    // Add all of the member functions from a compile-time table (a tuple of MemberFun entries).
+    template <typename... ENTRY_Ts>
+    void AddMembers(const std::tuple<ENTRY_Ts...> & table) {
+      member_funs.reserve(member_funs.size() + sizeof...(ENTRY_Ts));
+      std::apply([this](const auto &... entry){ (AddMember(entry), ...); }, table);
+    }
   };
 
 }
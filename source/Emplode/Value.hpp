@@ -0,0 +1,128 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Value.hpp
+ *  @brief Handle for the result of evaluating an expression.
+ *  @note Status: BETA
+ *
+ *  Evaluation either produces a new, temporary symbol (such as the result of 1+2) or refers to
+ *  an existing symbol (such as a variable).  When a Value goes out of scope it deletes its
+ *  symbol if that symbol is (still) temporary; any other symbol is only borrowed.  Values can
+ *  be moved but not copied, so each temporary has exactly one handle at a time.
+ *
+ *  A borrowed symbol may live inside a temporary (an entry of [1,2,3][1], or a member function
+ *  of a temporary list); the Value then also owns that temporary to keep the symbol valid.
+ *
+ *  A Value does not record ownership itself: the temporary flag on the symbol is checked each
+ *  time (in IsOwned(), Clear(), etc.).  This lets a callee take over a symbol that was passed
+ *  to it as a plain pointer (such as an argument to a list push) by clearing the flag, after
+ *  which the Value that produced it will no longer delete it.  Cleanup is automatic, but it
+ *  still branches on the flag.
+ *
+ *  A Value made with Borrow() never owns its symbol, even if that symbol is flagged temporary
+ *  (for example, a trigger argument that its caller will delete).  Handing such a symbol on
+ *  with Release() or Detach() produces a copy, so the real owner keeps it.
+ */
+
+#ifndef EMPLODE_VALUE_HPP
+#define EMPLODE_VALUE_HPP
+
+#include <type_traits>
+#include <utility>
+
+#include "emp/base/Ptr.hpp"
+
+#include "Symbol.hpp"
+
+namespace emplode {
+
+  class Value {
+  private:
+    emp::Ptr<Symbol> ptr = nullptr;     ///< Symbol produced by evaluation.
+    emp::Ptr<Symbol> owner = nullptr;   ///< Temporary that a borrowed ptr belongs to (if any).
+    bool borrowed = false;              ///< Never delete or hand over ptr, even if temporary.
+
+  public:
+    Value() = default;
+    Value(std::nullptr_t) { }
+    Value(emp::Ptr<Symbol> in) : ptr(in) { }
+    template <typename T, typename = std::enable_if_t<std::is_base_of_v<Symbol, T>>>
+    Value(emp::Ptr<T> in) : ptr(in) { }
+
+    /// Refer to a symbol that belongs to base, keeping base alive if it is owned.
+    Value(emp::Ptr<Symbol> in, Value && base) : ptr(in) {
+      owner = base.IsOwned() ? std::exchange(base.ptr, nullptr) : std::exchange(base.owner, nullptr);
+    }
+
+    /// Refer to a symbol owned elsewhere, whatever its temporary flag says.
+    static Value Borrow(emp::Ptr<Symbol> in) {
+      Value out(in);
+      out.borrowed = true;
+      return out;
+    }
+
+    Value(const Value &) = delete;
+    Value(Value && in) noexcept
+      : ptr(std::exchange(in.ptr, nullptr)), owner(std::exchange(in.owner, nullptr))
+      , borrowed(std::exchange(in.borrowed, false)) { }
+    ~Value() { Clear(); }
+
+    Value & operator=(const Value &) = delete;
+    Value & operator=(Value && in) noexcept {
+      if (&in != this) {
+        Clear();
+        ptr = std::exchange(in.ptr, nullptr);
+        owner = std::exchange(in.owner, nullptr);
+        borrowed = std::exchange(in.borrowed, false);
+      }
+      return *this;
+    }
+
+    emp::Ptr<Symbol> Get() const { return ptr; }
+    Symbol * operator->() const { return ptr.Raw(); }
+    Symbol & operator*() const { return *ptr; }
+    explicit operator bool() const { return ptr != nullptr; }
+
+    /// Will this handle delete its symbol?  (Checks the symbol's current temporary flag.)
+    bool IsOwned() const { return ptr && !borrowed && ptr->IsTemporary(); }
+    bool IsBorrowed() const { return borrowed; }
+
+    /// Delete anything owned; either way, the handle is left empty.
+    void Clear() {
+      if (IsOwned()) ptr.Delete();
+      if (owner) owner.Delete();
+      ptr = nullptr;
+      owner = nullptr;
+      borrowed = false;
+    }
+
+    /// Give up the symbol without deleting it; a temporary stays temporary for its next owner.
+    /// A symbol borrowed from a temporary is cloned first, since the temporary is freed.
+    emp::Ptr<Symbol> Release() {
+      emp::Ptr<Symbol> out = ptr;
+      if (out && ((owner && !out->IsTemporary()) || (borrowed && out->IsTemporary()))) {
+        out = out->ShallowClone();
+        out->SetTemporary();
+      }
+      ptr = nullptr;
+      Clear();
+      return out;
+    }
+
+    /// Produce a (non-temporary) symbol for the caller to keep: an owned symbol is handed over
+    /// directly, while a borrowed one is shallow cloned.
+    emp::Ptr<Symbol> Detach() {
+      if (!ptr) return nullptr;
+      emp::Ptr<Symbol> out = IsOwned() ? ptr : ptr->ShallowClone();
+      out->SetTemporary(false);
+      ptr = nullptr;
+      Clear();
+      return out;
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+/**
+ *  @note This file is part of Emplode, currently within https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  EmplodeMonitor.cpp
+ *  @brief Print live values from a shared-memory export (see Emplode/SharedExport.hpp).
+ *
+ *  Usage: EmplodeMonitor <segment> [interval_ms=1000] [max_lines=0 (no limit)]
+ *
+ *  Prints a header of value names, then one CSV line each time the exporting run publishes a
+ *  new update (checked every interval).  Exits when the segment goes away.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "Emplode/SharedExport.hpp"
+
+int main(int argc, char ** argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: EmplodeMonitor <segment> [interval_ms=1000] [max_lines=0]" << std::endl;
+    return 1;
+  }
+  const std::string segment = argv[1];
+  const auto interval = std::chrono::milliseconds(argc > 2 ? std::stoul(argv[2]) : 1000);
+  const size_t max_lines = (argc > 3) ? std::stoul(argv[3]) : 0;
+
+  emplode::SharedReader reader;
+  while (!reader.Open(segment)) std::this_thread::sleep_for(interval);
+
+  std::cout << "publish";
+  for (size_t i = 0; i < reader.GetNumValues(); ++i) std::cout << "," << reader.GetName(i);
+  std::cout << std::endl;
+
+  emp::vector<double> values;
+  uint64_t last_publish = 0;
+  size_t num_lines = 0;
+  while (max_lines == 0 || num_lines < max_lines) {
+    const uint64_t publish_id = reader.Read(values);
+    if (publish_id != last_publish) {
+      std::cout << publish_id;
+      for (double value : values) std::cout << "," << value;
+      std::cout << std::endl;
+      last_publish = publish_id;
+      ++num_lines;
+    }
+    std::this_thread::sleep_for(interval);
+
+    // Stop once the writer has removed the segment.
+    emplode::SharedReader probe;
+    if (!probe.Open(segment)) break;
+  }
+
+  return 0;
+}
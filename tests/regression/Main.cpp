@@ -1,4 +1,5 @@
 #include "Emplode.hpp"
+#include "SharedExport.hpp"   // Makes the "shared" DataFile backend available.
 
 using namespace emplode;
 
@@ -43,11 +44,8 @@ int main(int argc, char** argv) {
     }
 
     Emplode emplode;
-    std::vector<MyObject> objects;
-    emplode.AddType<MyObject>("MyObject", "Test object",
-        [&](const std::string &name) { objects.push_back(MyObject()); return &objects.back(); },
-        [&](const EmplodeType & from, EmplodeType & to) { return true; }
-    );
+    emplode.SetStepLimit(100000);  // Abort runaway scripts (see budget.emp).
+    emplode.AddPooledType<MyObject>("MyObject", "Test object");
     emplode.Load(argv[1]);
 
     return 0;
@@ -1,12 +1,18 @@
 # Script to run regression tests and check output
+# With --leak-check, run the sanitizer build (see "make leak-check") and also fail any test
+# that reports a memory error or leak.
 
 import subprocess
+import sys
+
+leak_check = "--leak-check" in sys.argv
+executable = "./Emplode-asan" if leak_check else "./Emplode"
 
 # Make Emplode executable
 success = 0
 failure = 0
 
-for test in ["hello_world", "functions", "refs", "fib", "list", "arrays", "objects"]:
+for test in ["hello_world", "functions", "refs", "fib", "list", "arrays", "objects", "budget", "builtins", "signals", "listmath", "datafile", "printf", "ownership", "shared", "invariants", "inline", "memo", "for", "menu"]:
     # Find expected output
     file = open(test + ".emp", "r")
     line = file.readline()
@@ -20,15 +26,18 @@ for test in ["hello_world", "functions", "refs", "fib", "list", "arrays", "objec
             break
 
     # Run script and compare
-    result = subprocess.run(["./Emplode", test+".emp"], text=True, capture_output=True)
+    result = subprocess.run([executable, test+".emp"], text=True, capture_output=True)
     stdout = result.stdout.strip()
-    if stdout == output:
+    sanitizer_error = leak_check and "Sanitizer" in result.stderr
+    if stdout == output and not sanitizer_error:
         print("\033[32mPassed:", test, "\033[0m")
         success += 1
     else:
         print("\033[31;1mFailed:", test, "\033[0m")
         print('  Expected: \"', output, '"', sep='')
         print('  Found:    \"', stdout, '"', sep='')
+        if sanitizer_error:
+            print(result.stderr)
         failure += 1
 
 print()
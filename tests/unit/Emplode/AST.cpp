@@ -15,3 +15,39 @@
 
 
 TEST_CASE("AST_Placeholder", "[Emplode]"){ ; }
+
+TEST_CASE("AST_Var", "[Emplode]"){
+  // Copies of a Var share one value.
+  emplode::Var var(emp::NewPtr<emplode::Symbol_Var>(1.0));
+  CHECK(!var.IsLinked());
+  emplode::Var copy(var);
+  copy.SetValue(emp::NewPtr<emplode::Symbol_Var>(2.0));
+  CHECK(var.GetValue()->AsDouble() == 2.0);
+
+  // Moving and reassigning keep the value alive until the last reference goes away.
+  emplode::Var moved(std::move(copy));
+  var = emplode::Var(emp::NewPtr<emplode::Symbol_Var>(3.0));
+  CHECK(moved.GetValue()->AsDouble() == 2.0);
+  CHECK(var.GetValue()->AsDouble() == 3.0);
+  var = moved;
+  CHECK(var.GetValue()->AsDouble() == 2.0);
+
+  // Linked variables go through their functions.
+  double value = 5.0;
+  emp::Ptr<emplode::Symbol> current = nullptr;
+  emplode::Var linked(
+    [&value, &current](){
+      if (current) current.Delete();
+      current = emp::NewPtr<emplode::Symbol_Var>(value);
+      return current;
+    },
+    [&value](emp::Ptr<emplode::Symbol> in){ value = in->AsDouble(); in.Delete(); }
+  );
+  emplode::Var linked_copy = linked;
+  CHECK(linked_copy.IsLinked());
+  CHECK(linked_copy.GetValue()->AsDouble() == 5.0);
+  linked.SetValue(emp::NewPtr<emplode::Symbol_Var>(7.0));
+  CHECK(value == 7.0);
+  CHECK(linked_copy.GetValue()->AsDouble() == 7.0);
+  current.Delete();
+}
@@ -0,0 +1,53 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ChildProcess.hpp
+ *  @brief Run code that is expected to exit (or abort) in a separate process, for tests.
+ *
+ *  Script errors end the program with exit(1), so tests of them run the failing code in a
+ *  forked child.  RunInChild() returns the child's exit status along with everything it wrote
+ *  to stderr.  A child killed by a signal reports 128 + the signal number (as shells do); the
+ *  child's SIGABRT handler is reset first, so an abort is not reported as a Catch failure.
+ */
+
+#ifndef EMPLODE_TESTS_CHILD_PROCESS_HPP
+#define EMPLODE_TESTS_CHILD_PROCESS_HPP
+
+#include <csignal>
+#include <string>
+#include <utility>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+/// Run fun in a child process; return its exit status and anything it wrote to stderr.
+template <typename FUN_T>
+std::pair<int, std::string> RunInChild(FUN_T fun) {
+  int err_pipe[2];
+  if (pipe(err_pipe) != 0) return { -1, "unable to create pipe" };
+  const pid_t pid = fork();
+  if (pid == 0) {
+    close(err_pipe[0]);
+    dup2(err_pipe[1], STDERR_FILENO);
+    close(err_pipe[1]);
+    std::signal(SIGABRT, SIG_DFL);
+    fun();
+    _exit(0);
+  }
+  close(err_pipe[1]);
+
+  std::string err;
+  char buffer[256];
+  ssize_t count;
+  while ((count = read(err_pipe[0], buffer, sizeof(buffer))) > 0) err.append(buffer, count);
+  close(err_pipe[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (WIFSIGNALED(status)) return { 128 + WTERMSIG(status), err };
+  return { WIFEXITED(status) ? WEXITSTATUS(status) : -1, err };
+}
+
+#endif
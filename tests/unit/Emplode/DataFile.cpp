@@ -1,17 +1,110 @@
 /**
  *  @note This file is part of MABE, https://github.com/mercere99/MABE2
  *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
- *  @date 2019-2021.
+ *  @date 2019-2022.
  *
  *  @file  DataFile.cpp
- *  @brief TODO. Currently this is a placeholder so codecov will see the untested source code
+ *  @brief Tests for DataFile output, including parallel evaluation of pure columns.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
 // CATCH
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 // MABE
 #include "Emplode/DataFile.hpp"
+#include "Emplode/Emplode.hpp"
+
+#include "ChildProcess.hpp"
+
+TEST_CASE("DataFile_PureColumns", "[Emplode]"){
+  emp::StreamManager files;
+  files.SetOutputDefaultFile();
+  emplode::DataFile serial("serial", files);
+  emplode::DataFile parallel("parallel", files);
+  serial.SetFilename("temp/serial.csv");
+  parallel.SetFilename("temp/parallel.csv");
+
+  emp::vector<double> population{ 3.0, 1.0, 4.0, 1.0, 5.0, 9.0, 2.0, 6.0 };
+  size_t update = 0;
+  std::atomic<size_t> pure_calls{0};
+
+  for (emplode::DataFile * df : { &serial, &parallel }) {
+    df->AddSetup([&update](){ ++update; });
+    df->AddColumn("update", [&update](){ return std::to_string(update); });
+    df->AddColumn("sum", [&](){
+      ++pure_calls;
+      double total = 0.0;
+      for (double x : population) total += x;
+      return std::to_string(total);
+    }, true);
+    df->AddColumn("max", [&](){
+      ++pure_calls;
+      double best = population[0];
+      for (double x : population) best = std::max(best, x);
+      return std::to_string(best);
+    }, true);
+    df->AddColumn("count", [&](){ return std::to_string(population.size()); }, true);
+  }
+  const size_t num_threads = std::min<size_t>(4, emplode::DataFile::GetMaxThreads());
+  CHECK(parallel.SetNumThreads(4) == num_threads);
+  CHECK(parallel.GetNumThreads() == num_threads);
+  CHECK(serial.GetNumThreads() == 1);
+
+  // Setup commands run before any column, so both files see the same update numbers.
+  for (size_t i = 0; i < 50; ++i) {
+    update = i * 10;
+    serial.Write();
+    update = i * 10;
+    parallel.Write();
+    population[i % population.size()] += 1.5;
+  }
+  CHECK(update == 491);
+  CHECK(pure_calls == 200);
+
+  // Both files hold identical text, with columns in their original order.
+  files.GetOutputStream("temp/serial.csv").flush();
+  files.GetOutputStream("temp/parallel.csv").flush();
+  std::stringstream serial_text, parallel_text;
+  serial_text << std::ifstream("temp/serial.csv").rdbuf();
+  parallel_text << std::ifstream("temp/parallel.csv").rdbuf();
+  CHECK(serial_text.str() == parallel_text.str());
+  CHECK(serial_text.str().substr(0, 44) == "update,sum,max,count\n1,31.000000,9.000000,8\n");
+}
+
+// The shared backend is opt-in, so DataFile alone must not pull in the POSIX shm headers.
+#ifdef MAP_SHARED
+#error "DataFile.hpp should not include <sys/mman.h>; see SharedExportBase.hpp."
+#endif
+
+TEST_CASE("DataFile_SharedOptIn", "[Emplode]"){
+  CHECK(emplode::SharedExportBase::Factory() == nullptr);
+  CHECK(emplode::SharedExportBase::Make("emplode_test_unused") == nullptr);
+}
+
+// Load statements in a child process; return its exit status and anything written to stderr.
+static std::pair<int, std::string> LoadInChild(const std::string & statements) {
+  return RunInChild([&statements](){
+    emplode::Emplode emplode;
+    emplode.LoadStatements(statements, "child");
+  });
+}
 
+TEST_CASE("DataFile_SetThreads", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.LoadStatements("DataFile f;", "setup");
+  const double max_threads = static_cast<double>(emplode::DataFile::GetMaxThreads());
+  CHECK(emplode.Execute("f.SET_THREADS(1)").AsDouble() == 1.0);
+  CHECK(emplode.Execute("f.SET_THREADS(1000000)").AsDouble() == max_threads);   // Capped.
+  CHECK(emplode.Execute("f.SET_THREADS(1)").AsDouble() == 1.0);
 
-TEST_CASE("DataFile_Placeholder", "[Emplode]"){ ; }
+  for (std::string bad : { "0", "-1", "2.5" }) {
+    auto [status, err] = LoadInChild("DataFile f; PRINT(\"ran\"); f.SET_THREADS(" + bad + ");");
+    CHECK(status == 1);
+    CHECK(err.find("SET_THREADS needs a whole number of at least 1") != std::string::npos);
+  }
+}
@@ -0,0 +1,122 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  DataTable.cpp
+ *  @brief Tests for in-memory data tables and the DataFile memory backend.
+ */
+
+#include <cmath>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/DataFile.hpp"
+#include "Emplode/DataTable.hpp"
+
+TEST_CASE("DataTable_Ring", "[Emplode]"){
+  emplode::DataTable table;
+  table.AddColumn("update");
+  table.AddColumn("label");
+  table.SetMaxRows(3);
+
+  for (size_t i = 0; i < 5; ++i) {
+    table.AddRow({ emp::Datum(i * 1.0), emp::Datum(std::to_string(i * 10)) });
+  }
+  CHECK(table.GetNumRows() == 3);
+  CHECK(table.GetColumnID("label") == 1);
+  CHECK(table.GetColumnID("missing") == 2);
+
+  // Numeric-looking strings stay numeric; rows are oldest first.
+  CHECK(table.IsNumeric(1));
+  CHECK(table.Get(0, 0).AsDouble() == 2.0);
+  CHECK(table.Get(1, 2).AsDouble() == 40.0);
+
+  // Spans cover the ring in row order without copying.
+  auto [first, second] = table.GetNumbers(0);
+  CHECK(first.size() + second.size() == 3);
+  emp::vector<double> values(first.begin(), first.end());
+  values.insert(values.end(), second.begin(), second.end());
+  CHECK(values == emp::vector<double>{2.0, 3.0, 4.0});
+
+  // A non-numeric value converts the column to strings, keeping earlier rows.
+  table.AddRow({ emp::Datum(5.0), emp::Datum("none") });
+  CHECK(!table.IsNumeric(1));
+  CHECK(table.Get(1, 1).AsString() == "40");
+  CHECK(table.Get(1, 2).AsString() == "none");
+  auto [str_first, str_second] = table.GetStrings(1);
+  CHECK(str_first.size() + str_second.size() == 3);
+}
+
+// Changing the row limit or the columns keeps whatever history still fits.
+TEST_CASE("DataTable_Resize", "[Emplode]"){
+  emplode::DataTable table;
+  table.AddColumn("update");
+  table.AddColumn("label");
+  table.SetMaxRows(4);
+  for (size_t i = 0; i < 6; ++i) {     // Wraps around: rows hold 2, 3, 4, 5.
+    table.AddRow({ emp::Datum(i * 1.0), emp::Datum("r" + std::to_string(i)) });
+  }
+
+  table.SetMaxRows(2);                 // Keep the newest two.
+  CHECK(table.GetNumRows() == 2);
+  CHECK(table.Get(0, 0).AsDouble() == 4.0);
+  CHECK(table.Get(1, 1).AsString() == "r5");
+
+  table.SetMaxRows(0);                 // Grow again; nothing more is dropped.
+  table.AddRow({ emp::Datum(6.0), emp::Datum("r6") });
+  CHECK(table.GetNumRows() == 3);
+  auto [first, second] = table.GetNumbers(0);
+  emp::vector<double> values(first.begin(), first.end());
+  values.insert(values.end(), second.begin(), second.end());
+  CHECK(values == emp::vector<double>{4.0, 5.0, 6.0});
+
+  // New columns are empty (NaN) for earlier rows.
+  table.AddColumn("size");
+  table.AddRow({ emp::Datum(7.0), emp::Datum("r7"), emp::Datum(70.0) });
+  CHECK(std::isnan(table.Get(2, 0).AsDouble()));
+  CHECK(table.Get(2, 3).AsDouble() == 70.0);
+
+  // Columns are matched by name: a renamed column starts over; the others keep their values.
+  table.SetColumns({ "size", "update", "name" });
+  CHECK(table.GetNumCols() == 3);
+  CHECK(table.GetColumnID("label") == 3);
+  CHECK(table.Get(1, 3).AsDouble() == 7.0);
+  CHECK(table.Get(0, 3).AsDouble() == 70.0);
+  CHECK(std::isnan(table.Get(2, 3).AsDouble()));
+}
+
+TEST_CASE("DataTable_DataFile", "[Emplode]"){
+  emp::StreamManager files;
+  emplode::DataFile df("memory", files);
+  df.SetBackend(emplode::DataFile::Backend::MEMORY);
+
+  double fitness = 0.0;
+  df.AddSetup([&fitness](){ fitness += 0.5; });
+  df.AddColumn("fitness", [&fitness](){ return fitness; });
+  df.AddColumn("name", [](){ return std::string("org"); });
+  for (size_t i = 0; i < 10; ++i) df.Write();
+
+  // Nothing was written as text.
+  CHECK(!files.Has(df.GetFilename()));
+
+  const emplode::DataTable & table = df.GetTable();
+  CHECK(table.GetNumRows() == 10);
+  auto [fit_values, fit_rest] = table.GetNumbers(0);
+  CHECK(fit_rest.size() == 0);
+  CHECK(fit_values[9] == 5.0);
+  CHECK(df.Get("fitness", -2).AsDouble() == 4.5);
+  CHECK(df.Get("name", 3).AsString() == "org");
+
+  // Lowering max_rows or adding a column during the run keeps the newest history.
+  df.SetMaxRows(4);
+  df.AddColumn("twice", [&fitness](){ return 2.0 * fitness; });
+  df.Write();
+  CHECK(table.GetNumRows() == 4);
+  CHECK(df.Get("fitness", 0).AsDouble() == 4.0);
+  CHECK(df.Get("fitness", -1).AsDouble() == 5.5);
+  CHECK(std::isnan(df.Get("twice", 0).AsDouble()));
+  CHECK(df.Get("twice", -1).AsDouble() == 11.0);
+}
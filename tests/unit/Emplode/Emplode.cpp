@@ -7,6 +7,8 @@
  *  @brief TODO. Currently this is a placeholder so codecov will see the untested source code
  */
 
+#include <thread>
+
 // CATCH
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
@@ -15,3 +17,36 @@
 
 
 TEST_CASE("Emplode_Placeholder", "[Emplode]"){ ; }
+
+TEST_CASE("Emplode_SharedBuiltins", "[Emplode]"){
+  emplode::Emplode emplode1;
+  emplode::Emplode emplode2;
+
+  // Both instances see the shared library functions.
+  CHECK(emplode1.Execute("SQRT(16)").AsDouble() == 4.0);
+  CHECK(emplode2.Execute("SQRT(16)").AsDouble() == 4.0);
+
+  // An instance can override a library function without affecting other instances.
+  emplode1.AddFunction("SQRT", [](double x){ return x * 10.0; }, "Not really a square root");
+  CHECK(emplode1.Execute("SQRT(16)").AsDouble() == 160.0);
+  CHECK(emplode2.Execute("SQRT(16)").AsDouble() == 4.0);
+}
+
+TEST_CASE("Emplode_SharedBuiltinsThreads", "[Emplode]"){
+  // Instances on different threads copy the same library variables during lookups, and
+  // draw definition IDs for their functions from the same counter.
+  double results[2] = { 0.0, 0.0 };
+  auto run = [&results](size_t id) {
+    for (size_t i = 0; i < 50; ++i) {
+      emplode::Emplode emplode;
+      emplode.LoadStatements("Var inc(x) { RETURN x + 1; };", "thread");
+      results[id] += emplode.Execute("inc(SQRT(4)+ABS(-1))").AsDouble();
+    }
+  };
+  std::thread thread0(run, 0);
+  std::thread thread1(run, 1);
+  thread0.join();
+  thread1.join();
+  CHECK(results[0] == 200.0);
+  CHECK(results[1] == 200.0);
+}
@@ -7,11 +7,197 @@
  *  @brief TODO. Currently this is a placeholder so codecov will see the untested source code
  */
 
+#include <string>
+
 // CATCH
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 // MABE
 #include "Emplode/EventManager.hpp"
+#include "Emplode/Emplode.hpp"
 
+#include "ChildProcess.hpp"
 
 TEST_CASE("EventManager_Placeholder", "[Emplode]"){ ; }
+
+TEST_CASE("EventManager_Schedules", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddSignal("UPDATE");
+  emplode.LoadStatements(emp::vector<std::string>{
+    "Var every_count = 0;",
+    "Var range_count = 0;",
+    "Var at_count = 0;",
+    "Var all_count = 0;",
+    "Var last_t = -1;",
+    "Var cur_t = -1;",
+    "Var period = 10;",
+    "Var order = \"\";",
+    "@UPDATE EVERY period every_count = every_count + 1;",
+    "@UPDATE(last_t) EVERY 10 FROM 5 UNTIL 40 range_count = range_count + 1;",
+    "@UPDATE AT 17 at_count = at_count + 1;",
+    "@UPDATE(cur_t) all_count = all_count + 1;",
+    "@UPDATE EVERY 50 order = order + \"a\";",
+    "@UPDATE(cur_t) IF (cur_t % 50 == 0) order = order + \"b\";",
+    "@UPDATE EVERY 50 order = order + \"c\";",
+    "period = 25;"  // Schedules are evaluated at the first trigger.
+  }, "schedule test");
+
+  for (int t = 0; t < 100; ++t) emplode.Trigger("UPDATE", t);
+
+  CHECK(emplode.Execute("every_count").AsDouble() == 4.0);   // 0, 25, 50, 75
+  CHECK(emplode.Execute("range_count").AsDouble() == 4.0);   // 5, 15, 25, 35
+  CHECK(emplode.Execute("last_t").AsDouble() == 35.0);
+  CHECK(emplode.Execute("at_count").AsDouble() == 1.0);
+  CHECK(emplode.Execute("all_count").AsDouble() == 100.0);
+  CHECK(emplode.Execute("order").AsString() == "abcabc");    // Definition order is kept.
+
+  // Skipped times still run a missed action once, then resume on the schedule.
+  emplode.Trigger("UPDATE", 160);
+  CHECK(emplode.Execute("every_count").AsDouble() == 5.0);
+  emplode.Trigger("UPDATE", 170);
+  CHECK(emplode.Execute("every_count").AsDouble() == 5.0);
+  emplode.Trigger("UPDATE", 175);
+  CHECK(emplode.Execute("every_count").AsDouble() == 6.0);
+}
+
+TEST_CASE("EventManager_Deferred", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddSignal("UPDATE");
+  emplode.LoadStatements(emp::vector<std::string>{
+    "SIGNAL Hit(value);",
+    "SIGNAL Echo(value);",
+    "Var hit_value = 0;",
+    "Var echo_value = 0;",
+    "Var log = \"\";",
+    "@Hit(hit_value) { log = log + \"h\" + hit_value; TRIGGER Echo(hit_value * 10); }",
+    "@Echo(echo_value) log = log + \"e\" + echo_value;",
+    "@UPDATE(hit_value) { TRIGGER Echo(hit_value + 100); TRIGGER Hit(hit_value); }"
+  }, "deferred test");
+
+  // Immediate delivery runs actions recursively, in trigger order.
+  emplode.Trigger("UPDATE", 1);
+  CHECK(emplode.Execute("log").AsString() == "e101h1e10");
+
+  // Deferred triggers wait for delivery, then run grouped by signal (in declaration order).
+  emplode.Execute("log = \"\"");
+  emplode.SetSignalDeferred("Hit");
+  emplode.SetSignalDeferred("Echo");
+  emplode.Trigger("UPDATE", 1);
+  emplode.Trigger("UPDATE", 2);
+  CHECK(emplode.Execute("log").AsString() == "");
+  CHECK(emplode.GetSymbolTable().GetNumQueuedTriggers() == 4);
+
+  // Echoes triggered while delivering Hit go into a second batch rather than recursing.
+  emplode.DeliverTriggers();
+  CHECK(emplode.Execute("log").AsString() == "h1h2e101e102e10e20");
+  CHECK(emplode.GetSymbolTable().GetNumQueuedTriggers() == 0);
+
+  // Host triggers are queued too.
+  emplode.Execute("log = \"\"");
+  emplode.Trigger("Echo", 7);
+  CHECK(emplode.Execute("log").AsString() == "");
+  emplode.DeliverTriggers();
+  CHECK(emplode.Execute("log").AsString() == "e7");
+}
+
+TEST_CASE("EventManager_PriorityGuardRemove", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddSignal("Hit");
+  emplode.LoadStatements(emp::vector<std::string>{
+    "Var v = 0;",
+    "Var w = 0;",
+    "Var log = \"\";",
+    "@Hit(v) log = log + \"a\";",
+    "@Hit(v) PRIORITY 10 log = log + \"b\";",
+    "@Hit(w) PRIORITY -1 WHEN (w > 5) log = log + \"c\" + w;",
+    "@Hit(v) PRIORITY 10 EVERY 2 log = log + \"d\";",
+    "@Hit(v) WHEN (v % 2 == 1 && log != \"\") log = log + \"e\";"
+  }, "priority test");
+
+  // Higher priorities run first; ties keep definition order (scheduled actions included).
+  emplode.Trigger("Hit", 2);
+  CHECK(emplode.Execute("log").AsString() == "bda");
+
+  // Guards see the trigger arguments before parameters are set; failed guards set nothing.
+  emplode.Execute("log = \"\"");
+  emplode.Trigger("Hit", 7);                 // "d" is due again (EVERY 2).
+  CHECK(emplode.Execute("log").AsString() == "bdaec7");
+  CHECK(emplode.Execute("w").AsDouble() == 7.0);
+  emplode.Execute("log = \"\"");
+  emplode.Trigger("Hit", 3);
+  CHECK(emplode.Execute("log").AsString() == "bae");
+  CHECK(emplode.Execute("w").AsDouble() == 7.0);
+
+  // Actions can be removed by handle; handles are listed in run order.
+  emp::vector<size_t> handles = emplode.GetActionHandles("Hit");
+  REQUIRE(handles.size() == 5);
+  CHECK(emplode.RemoveAction(handles[0]));   // Remove "b"
+  CHECK(emplode.RemoveAction(handles[2]));   // Remove "a"
+  CHECK(!emplode.RemoveAction(handles[2]));  // Already removed.
+  emplode.Execute("log = \"\"");
+  emplode.Trigger("Hit", 9);
+  CHECK(emplode.Execute("log").AsString() == "dec9");
+  CHECK(emplode.GetActionHandles("Hit").size() == 3);
+}
+
+// Parse statements in a child process; return its exit status and anything written to stderr.
+// Guards read trigger arguments in place, for any number of parameters, without taking them.
+TEST_CASE("EventManager_GuardArgs", "[Emplode]"){
+  constexpr size_t NUM_PARAMS = 70;
+  std::string vars, params, args;
+  for (size_t i = 0; i < NUM_PARAMS; ++i) {
+    if (i) { params += ", "; args += ", "; }
+    vars += "Var p" + std::to_string(i) + "; ";
+    params += "p" + std::to_string(i);
+    args += "x + " + std::to_string(i);
+  }
+
+  emplode::Emplode emplode;
+  emplode.LoadStatements(emp::vector<std::string>{
+    "SIGNAL Many(" + params + ");",
+    "SIGNAL Keep(s);",
+    vars + "Var s;",
+    "Var log = \"\";",
+    "Var kept = [];",
+    "@Many(" + params + ") WHEN (p69 > 75) log = log + p0 + \",\";",
+    "@Keep(s) WHEN (kept.push(s) == kept.pop()) log = log + s;",
+    "Var RunMany(x) { TRIGGER Many(" + args + "); RETURN 0; };"
+  }, "guard args");
+
+  emplode.Execute("RunMany(1)");                 // p69 = 70: guard fails.
+  emplode.Execute("RunMany(10)");                // p69 = 79: guard passes.
+  CHECK(emplode.Execute("log").AsString() == "10,");
+
+  // A function called from a guard that keeps a (temporary) argument gets its own copy.
+  emplode.Execute("log = \"\"");
+  emplode.LoadStatements("Var a = \"a\"; TRIGGER Keep(a + \"b\");", "keep");
+  CHECK(emplode.Execute("log").AsString() == "ab");
+}
+
+// Load statements in a child process; return its exit status and anything written to stderr.
+static std::pair<int, std::string> LoadInChild(const std::string & statements) {
+  return RunInChild([&statements](){
+    emplode::Emplode emplode;
+    emplode.AddSignal("UPDATE");   // Signals added in C++ take any number of arguments.
+    emplode.LoadStatements(statements, "child");
+  });
+}
+
+TEST_CASE("EventManager_TriggerArgCount", "[Emplode]"){
+  // TRIGGER must match the number of parameters a SIGNAL declares; this is checked at parse time.
+  auto [status, err] = LoadInChild("SIGNAL S(x); PRINT(\"ran\"); TRIGGER S(1, 2);");
+  CHECK(status == 1);
+  CHECK(err.find("Signal 'S' expects 1 arguments, but TRIGGER gave 2") != std::string::npos);
+
+  std::tie(status, err) = LoadInChild("SIGNAL S(x, y); TRIGGER S(1);");
+  CHECK(status == 1);
+  CHECK(err.find("Signal 'S' expects 2 arguments, but TRIGGER gave 1") != std::string::npos);
+
+  std::tie(status, err) = LoadInChild("SIGNAL S; TRIGGER S(1);");
+  CHECK(status == 1);
+  CHECK(err.find("Signal 'S' expects 0 arguments, but TRIGGER gave 1") != std::string::npos);
+
+  std::tie(status, err) = LoadInChild("SIGNAL S(x, y); TRIGGER S(1, 2); TRIGGER UPDATE; TRIGGER UPDATE(1, 2);");
+  CHECK(status == 0);
+  CHECK(err.empty());
+}
@@ -0,0 +1,80 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ListMath.cpp
+ *  @brief Tests for elementwise math over lists.
+ */
+
+#include <cmath>
+#include <limits>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/ListMath.hpp"
+
+// Vector kernels must match their scalar versions exactly, including the remainder loop and
+// special values.
+template <typename OP>
+void CheckKernel(const emp::vector<emp::vector<double>> & inputs) {
+  const size_t n = inputs[0].size();
+  emp::vector<const double *> in_ptrs;
+  for (const auto & input : inputs) in_ptrs.push_back(input.data());
+  emp::vector<double> out(n);
+  emplode::ListMath::Kernel<OP>(in_ptrs.data(), out.data(), n);
+  for (size_t i = 0; i < n; ++i) {
+    double expected = 0.0;
+    if constexpr (OP::ARITY == 1) expected = OP::Scalar(inputs[0][i]);
+    if constexpr (OP::ARITY == 2) expected = OP::Scalar(inputs[0][i], inputs[1][i]);
+    if constexpr (OP::ARITY == 3) expected = OP::Scalar(inputs[0][i], inputs[1][i], inputs[2][i]);
+    if (std::isnan(expected)) CHECK(std::isnan(out[i]));
+    else {
+      CHECK(out[i] == expected);
+      CHECK(std::signbit(out[i]) == std::signbit(expected));
+    }
+  }
+}
+
+TEST_CASE("ListMath_Kernels", "[Emplode]"){
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+  emp::vector<double> a{ 1.5, -2.0, 0.0, -0.0, nan, inf, 7.0, -inf, 3.25 };
+  emp::vector<double> b{ 2.0, -3.0, -0.0, 0.0, 1.0, nan, 7.0, 4.0, -1.0 };
+  emp::vector<double> c{ 5.0, -2.5, 1.0, 1.0, 2.0, 3.0, nan, 9.0, 0.5 };
+
+  CheckKernel<emplode::ListMath::OpAdd>({a, b});
+  CheckKernel<emplode::ListMath::OpSub>({a, b});
+  CheckKernel<emplode::ListMath::OpMul>({a, b});
+  CheckKernel<emplode::ListMath::OpDiv>({a, b});
+  CheckKernel<emplode::ListMath::OpSqrt>({a});
+  CheckKernel<emplode::ListMath::OpAbs>({a});
+  CheckKernel<emplode::ListMath::OpMin>({a, b});
+  CheckKernel<emplode::ListMath::OpMax>({a, b});
+  CheckKernel<emplode::ListMath::OpClamp>({a, b, c});
+}
+
+TEST_CASE("ListMath_Broadcast", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.Execute("Var v = [1, 4, 9, 16, 25]");
+
+  emplode.Execute("Var roots = SQRT(v)");
+  CHECK(emplode.Execute("roots[4]").AsDouble() == 5.0);
+  emplode.Execute("Var sums = v + roots");
+  CHECK(emplode.Execute("sums[2]").AsDouble() == 12.0);
+  emplode.Execute("Var scaled = 2 * v - 1");
+  CHECK(emplode.Execute("scaled[3]").AsDouble() == 31.0);
+
+  // Functions without a dedicated kernel broadcast too; scalars are unchanged.
+  emplode.Execute("Var pows = POW(v, 0.5)");
+  CHECK(emplode.Execute("pows[1]").AsDouble() == 2.0);
+  CHECK(emplode.Execute("MIN(3, 8)").AsDouble() == 3.0);
+
+  // Matrices are handled row by row.
+  emplode.Execute("Var m = [[1, -2], [-3, 4]]");
+  emplode.Execute("Var m_abs = ABS(m)");
+  CHECK(emplode.Execute("m_abs[1][0]").AsDouble() == 3.0);
+}
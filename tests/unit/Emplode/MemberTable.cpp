@@ -0,0 +1,114 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  MemberTable.cpp
+ *  @brief Tests for registering member functions from a compile-time table.
+ */
+
+#include <string>
+#include <tuple>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/MemberTable.hpp"
+
+#include "ChildProcess.hpp"
+
+using symbol_ptr_t = emp::Ptr<emplode::Symbol>;
+
+class TableTest : public emplode::EmplodeType {
+private:
+  double total = 0.0;
+  std::string label = "none";
+
+public:
+  double Add(double x) { return total += x; }
+  double GetTotal() const { return total; }
+
+  static void InitType(emplode::TypeInfo & info) {
+    using emplode::MemberFun;
+    static constexpr std::tuple members{
+      MemberFun<&TableTest::Add>{"ADD", "Add to the total."},
+      MemberFun<&TableTest::GetTotal>{"TOTAL", "Return the total."},
+      MemberFun<[](TableTest & obj, const std::string & in, double count) {
+        obj.label = "";
+        for (size_t i = 0; i < count; ++i) obj.label += in;
+        return obj.label;
+      }>{"LABEL", "Set the label to count copies of a string."},
+      MemberFun<[](TableTest & obj, const emp::vector<symbol_ptr_t> & args) {
+        for (symbol_ptr_t arg : args) obj.total += arg->AsDouble();
+        return args.size();
+      }>{"ADD_ALL", "Add any number of values to the total."},
+    };
+    info.AddMembers(members);
+  }
+};
+
+TEST_CASE("MemberTable_Trampoline", "[Emplode]"){
+  using namespace emplode;
+  static_assert(MemberTrampoline<&TableTest::Add>::NUM_PARAMS == 1);
+  static_assert(MemberTrampoline<&TableTest::GetTotal>::NUM_PARAMS == 0);
+  static_assert(std::is_same_v<MemberTrampoline<&TableTest::GetTotal>::object_t, TableTest>);
+  static_assert(std::is_same_v<member_call_sig_t<&TableTest::GetTotal>, double(const TableTest &)>);
+  static_assert(std::is_same_v<member_call_sig_t<&TableTest::Add>, double(TableTest &, double)>);
+}
+
+TEST_CASE("MemberTable_Emplode", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode::TypeInfo & info = emplode.AddType<TableTest>("TableTest", "Object with a member table");
+
+  // Each entry records how many arguments it takes (-1 for any number).
+  CHECK(info.GetMemberFunctions().size() == 4);
+  REQUIRE(info.GetMemberFunction("ADD"));
+  CHECK(info.GetMemberFunction("ADD")->num_params == 1);
+  CHECK(info.GetMemberFunction("ADD")->trampoline);
+  CHECK(info.GetMemberFunction("TOTAL")->num_params == 0);
+  CHECK(info.GetMemberFunction("LABEL")->num_params == 2);
+  CHECK(info.GetMemberFunction("ADD_ALL")->num_params == -1);
+  CHECK(info.GetMemberFunction("LABEL")->desc == "Set the label to count copies of a string.");
+  CHECK(!info.GetMemberFunction("MISSING"));
+
+  emplode.LoadStatements("TableTest obj; obj.ADD(2); obj.ADD(3.5);", "test");
+  CHECK(emplode.Execute("obj.TOTAL()").AsDouble() == 5.5);
+  CHECK(emplode.Execute("obj.ADD_ALL(1, 2, 3)").AsDouble() == 3);
+  CHECK(emplode.Execute("obj.ADD_ALL()").AsDouble() == 0);
+  CHECK(emplode.Execute("obj.TOTAL()").AsDouble() == 11.5);
+  CHECK(emplode.Execute("obj.LABEL(\"ab\", 3)").AsString() == "ababab");
+
+  // Functions from the table are built in, so have a known return type.
+  CHECK(emplode.Execute("obj.TOTAL() + 1").AsDouble() == 12.5);
+
+  // Objects made later get the same member functions.
+  emplode.LoadStatements("TableTest obj2; obj2.ADD(obj.TOTAL());", "test2");
+  CHECK(emplode.Execute("obj2.TOTAL()").AsDouble() == 11.5);
+}
+
+// Parse statements in a child process; return its exit status and anything written to stderr.
+static std::pair<int, std::string> LoadInChild(const std::string & statements) {
+  return RunInChild([&statements](){
+    emplode::Emplode emplode;
+    emplode.AddType<TableTest>("TableTest", "Object with a member table");
+    emplode.LoadStatements(statements, "child");
+  });
+}
+
+TEST_CASE("MemberTable_WrongArgCount", "[Emplode]"){
+  // Calls with the wrong number of arguments are rejected while parsing, before anything runs.
+  auto [status, err] = LoadInChild("TableTest obj; PRINT(\"ran\"); obj.ADD(1, 2);");
+  CHECK(status == 1);
+  CHECK(err.find("'obj.ADD' expects 1 arguments, but was given 2") != std::string::npos);
+
+  std::tie(status, err) = LoadInChild("DataFile f; f.GET(\"x\");");
+  CHECK(status == 1);
+  CHECK(err.find("'f.GET' expects 2 arguments, but was given 1") != std::string::npos);
+
+  // Functions taking any number of arguments are not checked.
+  std::tie(status, err) = LoadInChild("TableTest obj; obj.ADD_ALL(1, 2, 3); obj.ADD_ALL();");
+  CHECK(status == 0);
+  CHECK(err.empty());
+}
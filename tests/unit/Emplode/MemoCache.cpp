@@ -0,0 +1,98 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  MemoCache.cpp
+ *  @brief Tests for caching the results of pure functions.
+ */
+
+#include <sstream>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/MemoCache.hpp"
+
+TEST_CASE("MemoCache_LRU", "[Emplode]"){
+  emplode::MemoCache cache(2);
+  emplode::Symbol_Var one(1.0), two(2.0), three(3.0), name(std::string("name"));
+  std::string key;
+  emp::Ptr<emplode::Symbol> result;
+
+  CHECK(emplode::MemoCache::MakeKey({&one, &name}, key));
+  CHECK(!cache.Find(key, result));
+  cache.Store(key, &three);
+  CHECK(cache.Find(key, result));
+  CHECK(result->AsDouble() == 3.0);
+  CHECK(result->IsTemporary());       // Each hit is a new copy.
+  result.Delete();
+
+  // Keys depend on argument values and types.
+  std::string key2;
+  emplode::Symbol_Var one_str(std::string("1"));
+  CHECK(emplode::MemoCache::MakeKey({&one_str, &name}, key2));
+  CHECK(key2 != key);
+
+  // Evict the least recently used.
+  std::string key_one, key_two;
+  emplode::MemoCache::MakeKey({&one}, key_one);
+  emplode::MemoCache::MakeKey({&two}, key_two);
+  cache.Store(key_one, &one);         // Evicts nothing; key is now least recent.
+  CHECK(cache.Find(key, result));     // key is most recent again.
+  result.Delete();
+  cache.Store(key_two, &two);         // Evicts key_one.
+  CHECK(!cache.Find(key_one, result));
+  CHECK(cache.Find(key_two, result));
+  result.Delete();
+
+  CHECK(cache.GetSize() == 2);
+  CHECK(cache.GetNumHits() == 3);
+  CHECK(cache.GetNumMisses() == 2);
+  CHECK(cache.GetNumEvictions() == 1);
+
+  cache.SetCapacity(1);
+  CHECK(cache.GetSize() == 1);
+  CHECK(cache.GetNumEvictions() == 2);
+
+  std::stringstream ss;
+  cache.PrintStats(ss);
+  CHECK(ss.str() == "hits=3 misses=2 evictions=2 bypassed=0 size=1/1\n");
+}
+
+TEST_CASE("MemoCache_Functions", "[Emplode]"){
+  emplode::Emplode emplode;
+  size_t calls = 0;
+  emplode.AddPureFunction("SLOW_SQUARE", [&calls](double x){ ++calls; return x * x; },
+                          "Square a value, slowly.", 4);
+
+  CHECK(emplode.Execute("SLOW_SQUARE(3) + SLOW_SQUARE(4) + SLOW_SQUARE(3)").AsDouble() == 34.0);
+  CHECK(calls == 2);                  // The repeated call is shared within the statement.
+  CHECK(emplode.Execute("SLOW_SQUARE(3)").AsDouble() == 9.0);
+  CHECK(calls == 2);                  // ...and remembered across statements.
+
+  auto & symbol = emplode.GetSymbolTable().GetRootScope().GetSymbol("SLOW_SQUARE")->GetValue()->AsFunction();
+  auto memo = symbol.GetMemo();
+  CHECK(memo->GetNumHits() == 1);
+  CHECK(memo->GetNumMisses() == 2);
+
+  // User functions from scripts.
+  emplode.LoadStatements("Var n = 0;  PURE(10) Var Count(x, s) { n = n + 1; RETURN s + x; };", "setup");
+  CHECK(emplode.Execute("Count(1, \"a\") + Count(1, \"a\") + Count(2, \"a\")").AsString() == "a1a1a2");
+  CHECK(emplode.Execute("n").AsDouble() == 2.0);
+
+  // Lists cannot be used as keys.
+  emplode.LoadStatements("PURE(4) Var First(l) { n = n + 1; RETURN l[0]; };", "list");
+  CHECK(emplode.Execute("First([5, 6]) + First([5, 6])").AsDouble() == 10.0);
+  CHECK(emplode.Execute("n").AsDouble() == 4.0);
+  CHECK(emplode.GetSymbolTable().GetRootScope().GetSymbol("First")->GetValue()->AsFunction()
+        .GetMemo()->GetNumBypassed() == 2);
+
+  // Turning memoization off.
+  symbol.SetMemo(0);
+  CHECK(!symbol.HasMemo());
+  CHECK(emplode.Execute("SLOW_SQUARE(3)").AsDouble() == 9.0);
+  CHECK(calls == 3);
+}
@@ -0,0 +1,62 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ObjectPool.cpp
+ *  @brief Tests for chunked, stable-address object storage.
+ */
+
+#include <csignal>
+
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+
+#include "ChildProcess.hpp"
+
+struct PoolTestObj : public emplode::EmplodeType {
+  int value = 0;
+  PoolTestObj() { }
+  PoolTestObj(int in) : value(in) { }
+};
+
+TEST_CASE("ObjectPool_Basic", "[Emplode]"){
+  emplode::ObjectPool<PoolTestObj, 4> pool;
+
+  // Build enough objects to span several chunks; addresses must never move.
+  emp::vector<emp::Ptr<PoolTestObj>> objs;
+  for (int i = 0; i < 10; ++i) objs.push_back(pool.New(i));
+  CHECK(pool.GetSize() == 10);
+  CHECK(pool.GetNumChunks() == 3);
+  for (int i = 0; i < 10; ++i) CHECK(objs[i]->value == i);
+
+  // Free a few objects and make sure iteration skips them.
+  pool.Free(objs[1]);
+  pool.Free(objs[6]);
+  CHECK(pool.GetSize() == 8);
+  CHECK(!pool.Has(objs[1]));
+  CHECK(pool.Has(objs[2]));
+  int total = 0;
+  pool.ForEach([&total](PoolTestObj & obj){ total += obj.value; });
+  CHECK(total == 45 - 1 - 6);
+
+  // Freed slots should be reused before new chunks are allocated.
+  auto reused = pool.New(100);
+  CHECK((reused == objs[6] || reused == objs[1]));
+  CHECK(pool.GetNumChunks() == 3);
+}
+
+TEST_CASE("ObjectPool_Emplode", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddPooledType<PoolTestObj>("PoolTestObj", "Pooled test object");
+  emplode.LoadStatements("PoolTestObj a; PoolTestObj b; PoolTestObj c;", "test");
+  CHECK(emplode.GetPool<PoolTestObj>().GetSize() == 3);
+
+  // Asking for the pool with a different chunk size fails even in release builds.
+  auto [status, err] = RunInChild([&emplode](){ emplode.GetPool<PoolTestObj, 16>(); });
+  CHECK(status == 128 + SIGABRT);
+}
@@ -0,0 +1,210 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Optimizer.cpp
+ *  @brief Tests for sharing repeated pure subexpressions and caching loop invariants.
+ */
+
+#include <cmath>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/Optimizer.hpp"
+
+TEST_CASE("Optimizer_Shared", "[Emplode]"){
+  emplode::Emplode emplode;
+  auto & optimizer = emplode.GetOptimizer();
+  emplode.LoadStatements("Var x = 3; Var y = 4; Var z = 0;", "setup");
+  CHECK(optimizer.GetNumShared() == 0);
+
+  CHECK(emplode.Execute("(x*y) + (x*y) * 2").AsDouble() == 36.0);
+  CHECK(optimizer.GetNumShared() == 2);
+
+  // Pure built-in functions are shared too.
+  CHECK(emplode.Execute("SQRT(x*x + y*y) + SQRT(x*x + y*y)").AsDouble() == 10.0);
+  CHECK(optimizer.GetNumShared() == 4);
+
+  // The cached value is recomputed each time the statement runs.
+  emplode.LoadStatements("Var total = 0; WHILE (z < 3) { total = total + (z+1)*(z+1) + (z+1); z = z + 1; }",
+               "loop");
+  CHECK(optimizer.GetNumShared() == 7);
+  CHECK(emplode.Execute("total").AsDouble() == 20.0);    // (1+1) + (4+2) + (9+3)
+
+  // Assignment targets are not values, so 'z' on the left is not shared with 'z+1' reads.
+  CHECK(emplode.Execute("z = z + 1").AsDouble() == 4.0);
+  CHECK(emplode.Execute("z").AsDouble() == 4.0);
+
+  // Disabled optimizers leave code alone.
+  optimizer.SetEnabled(false);
+  CHECK(emplode.Execute("(x*y) + (x*y)").AsDouble() == 24.0);
+  CHECK(optimizer.GetNumShared() == 7);
+}
+
+TEST_CASE("Optimizer_Impure", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.GetPrintSink().SetString();
+  auto & optimizer = emplode.GetOptimizer();
+
+  // Functions with side effects must run every time.
+  emplode.Execute("PRINT(1) + PRINT(1)");
+  CHECK(emplode.GetPrintSink().GetString() == "1\n1\n");
+
+  emplode.LoadStatements("Var count = 0;  Var Next() { count = count + 1; RETURN count; };", "setup");
+  CHECK(emplode.Execute("Next() * 10 + Next()").AsDouble() == 12.0);
+  CHECK(optimizer.GetNumShared() == 0);
+
+  // Pure expressions are not shared across an impure call that might change them.
+  CHECK(emplode.Execute("(count + 1) * Next() + (count + 1)").AsDouble() == 13.0);
+  CHECK(emplode.Execute("count").AsDouble() == 3.0);
+  CHECK(optimizer.GetNumShared() == 0);
+}
+
+TEST_CASE("Optimizer_Columns", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.LoadStatements(R"EMP(
+    Var x = 0;
+    Var calls = 0;
+    DataFile history { backend = "memory"; };
+    history.ADD_SETUP("x = x + 1");
+    history.ADD_COLUMN("a", "SQRT(x * 16)");
+    history.ADD_COLUMN("b", "SQRT(x * 16) + 1");
+    history.ADD_COLUMN("c", "x * 16");
+    history.WRITE();
+    history.WRITE();
+  )EMP", "columns");
+  CHECK(emplode.Execute("history.GET(\"a\", 0)").AsDouble() == 4.0);
+  CHECK(emplode.Execute("history.GET(\"b\", 0)").AsDouble() == 5.0);
+  CHECK(emplode.Execute("history.GET(\"c\", 1)").AsDouble() == 32.0);
+  CHECK(emplode.Execute("history.GET(\"b\", 1)").AsDouble() == Approx(std::sqrt(32.0) + 1.0));
+  CHECK(emplode.GetOptimizer().GetNumShared() == 4);   // 2x SQRT(x*16) and 2x x*16.
+
+  // A column added later (empty for earlier rows), using a variable defined later.
+  emplode.LoadStatements(R"EMP(
+    history.ADD_COLUMN("d", "later * 2");
+    Var later = 7;
+    history.WRITE();
+  )EMP", "more columns");
+  CHECK(emplode.Execute("history.NUM_ROWS()").AsDouble() == 3.0);
+  CHECK(std::isnan(emplode.Execute("history.GET(\"d\", 0)").AsDouble()));
+  CHECK(emplode.Execute("history.GET(\"d\", -1)").AsDouble() == 14.0);
+  CHECK(emplode.Execute("history.GET(\"a\", -1)").AsDouble() == Approx(std::sqrt(48.0)));
+}
+
+// Columns are statements (as with Execute), so they may update variables or end in ';'.
+TEST_CASE("Optimizer_ColumnStatements", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.LoadStatements(R"EMP(
+    Var x = 3;
+    Var lines = 0;
+    DataFile history { backend = "memory"; };
+    history.ADD_COLUMN("line", "lines = lines + 1");
+    history.ADD_COLUMN("x2", "x * 2;");
+    history.ADD_COLUMN("x2_again", "x * 2");
+    history.WRITE();
+    history.WRITE();
+  )EMP", "column statements");
+  CHECK(emplode.Execute("history.GET(\"line\", -1)").AsDouble() == 2.0);
+  CHECK(emplode.Execute("lines").AsDouble() == 2.0);
+  CHECK(emplode.Execute("history.GET(\"x2\", -1)").AsDouble() == 6.0);
+  CHECK(emplode.Execute("history.GET(\"x2_again\", 0)").AsDouble() == 6.0);
+}
+
+TEST_CASE("Optimizer_LoopInvariants", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.GetPrintSink().SetString();
+  auto & optimizer = emplode.GetOptimizer();
+  emplode.LoadStatements("Var n = 16; Var i = 0; Var t = 0; Var l = [2, 4];", "setup");
+
+  // SQRT(n) and l[1] * n are invariant; i * 2 and the loop test are not.
+  emplode.LoadStatements("WHILE (i < 4) { t = t + SQRT(n) + i * 2 + l[1] * n; i = i + 1; }",
+                         "loop");
+  CHECK(optimizer.GetNumHoisted() == 2);
+  CHECK(emplode.Execute("t").AsDouble() == 4 * 4 + 12 + 4 * 64);
+
+  // Rerunning the loop sees new values of its invariants.
+  emplode.LoadStatements("Var Run() { i = 0; t = 0; WHILE (i < 2) { t = t + SQRT(n); i = i + 1; } RETURN t; };",
+                         "function");
+  CHECK(optimizer.GetNumHoisted() == 3);
+  CHECK(emplode.Execute("Run()").AsDouble() == 8.0);
+  emplode.Execute("n = 81");
+  CHECK(emplode.Execute("Run()").AsDouble() == 18.0);
+
+  // Loops with impure calls or entry assignments are left alone.
+  emplode.LoadStatements("i = 0; WHILE (i < 2) { PRINT(SQRT(n)); i = i + 1; }", "impure");
+  emplode.LoadStatements("i = 0; WHILE (i < 2) { l[i] = SQRT(n); i = i + 1; }", "entries");
+  CHECK(optimizer.GetNumHoisted() == 3);
+  CHECK(emplode.Execute("l[1]").AsDouble() == 9.0);
+}
+
+TEST_CASE("Optimizer_Inline", "[Emplode]"){
+  emplode::Emplode emplode;
+  auto & optimizer = emplode.GetOptimizer();
+  emplode.LoadStatements("Var sq(x) { RETURN x*x; };  Var big(x) { RETURN x+x+x+x+x+x+x+x; };", "setup");
+
+  CHECK(emplode.Execute("sq(4) + sq(1)").AsDouble() == 17.0);
+  CHECK(optimizer.GetNumInlined() == 2);
+
+  // Size threshold.
+  optimizer.SetInlineLimit(8);
+  CHECK(emplode.Execute("big(2)").AsDouble() == 16.0);
+  CHECK(optimizer.GetNumInlined() == 2);
+  optimizer.SetInlineLimit(16);
+  CHECK(emplode.Execute("big(2)").AsDouble() == 16.0);
+  CHECK(optimizer.GetNumInlined() == 3);
+
+  // Functions with more than a RETURN, wrong argument counts, and calls to other user functions.
+  emplode.LoadStatements("Var two(x) { x = x + 1; RETURN x; };  Var outer(x) { RETURN sq(x) + 1; };",
+                         "more");
+  CHECK(emplode.Execute("two(1) + outer(2)").AsDouble() == 7.0);
+  CHECK(optimizer.GetNumInlined() == 4);    // Only sq() inside outer.
+
+  // Redefined functions fall back to normal calls.
+  emplode.LoadStatements("Var Run(v) { RETURN sq(v); };  Var sq_result = Run(3);", "run");
+  CHECK(emplode.Execute("sq_result").AsDouble() == 9.0);
+  emplode.Execute("sq = big");
+  CHECK(emplode.Execute("Run(3)").AsDouble() == 24.0);
+}
+
+TEST_CASE("Optimizer_Counting", "[Emplode]"){
+  emplode::Emplode emplode;
+  auto & optimizer = emplode.GetOptimizer();
+  emplode.LoadStatements("Var t = 0; Var c = 0; Var g = 0; Var calls = 0;", "setup");
+
+  emplode.LoadStatements("FOR (Var i = 0; i < 5; i = i + 1) t = t + i;", "observed");
+  CHECK(optimizer.GetNumUnboxed() == 1);
+  CHECK(emplode.Execute("t").AsDouble() == 10.0);
+
+  // The variable is only written at the end, and keeps the value that failed the test.
+  emplode.LoadStatements("FOR (c = 10; c > 0; c = c - 3) { t = t + 1; }", "unobserved");
+  CHECK(optimizer.GetNumUnboxed() == 2);
+  CHECK(emplode.Execute("c").AsDouble() == -2.0);
+  CHECK(emplode.Execute("t").AsDouble() == 14.0);
+
+  // A function called in the loop may read the variable.
+  emplode.LoadStatements("Var Show() { RETURN g; }; t = 0; FOR (g = 0; g < 4; g = g + 1) t = t + Show();",
+                         "call");
+  CHECK(optimizer.GetNumUnboxed() == 3);
+  CHECK(emplode.Execute("t").AsDouble() == 6.0);
+
+  // An impure limit is left to the normal loop.
+  emplode.LoadStatements("Var Limit() { calls = calls + 1; RETURN 3; }; FOR (c = 0; c < Limit(); c = c + 1) { }",
+                         "impure");
+  CHECK(optimizer.GetNumUnboxed() == 3);
+  CHECK(emplode.Execute("calls").AsDouble() == 4.0);
+  CHECK(emplode.Execute("c").AsDouble() == 3.0);
+
+  // Range loops count either way.
+  emplode.LoadStatements("t = 0; FOR (c IN 2..6) { t = t + 1; }", "range");
+  CHECK(optimizer.GetNumUnboxed() == 4);
+  CHECK(emplode.Execute("c").AsDouble() == 6.0);
+  optimizer.SetEnabled(false);
+  emplode.LoadStatements("FOR (c IN 2..6) { t = t + c; }", "range_plain");
+  CHECK(optimizer.GetNumUnboxed() == 4);
+  CHECK(emplode.Execute("t").AsDouble() == 4.0 + 2 + 3 + 4 + 5);
+  CHECK(emplode.Execute("c").AsDouble() == 6.0);
+}
@@ -0,0 +1,122 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  OutputPool.cpp
+ *  @brief Tests for pooled file output and its use by DataFile.
+ */
+
+#include <fstream>
+#include <sstream>
+
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/DataFile.hpp"
+#include "Emplode/Emplode.hpp"
+#include "Emplode/OutputPool.hpp"
+
+#include "ChildProcess.hpp"
+
+static std::string ReadFile(const std::string & filename) {
+  std::stringstream text;
+  text << std::ifstream(filename).rdbuf();
+  return text.str();
+}
+
+TEST_CASE("OutputPool_LRU", "[Emplode]"){
+  const size_t num_files = 10;
+  {
+    emplode::OutputPool pool;
+    pool.SetMaxOpen(4);
+    pool.SetBufferSize(1);    // Write every line right away to force reopening.
+
+    for (size_t line = 0; line < 3; ++line) {
+      for (size_t i = 0; i < num_files; ++i) {
+        pool.Write("temp/pool" + std::to_string(i) + ".txt", std::to_string(line) + "\n");
+        CHECK(pool.GetNumOpen() <= 4);
+      }
+    }
+    CHECK(pool.GetNumFiles() == num_files);
+    CHECK(pool.GetNumOpen() == 4);
+    CHECK(pool.GetNumOpens() == 3 * num_files);   // Round-robin defeats the LRU every time.
+
+    // Lowering the cap closes files right away.
+    pool.SetMaxOpen(2);
+    CHECK(pool.GetNumOpen() == 2);
+  }
+
+  // Reopened files were appended to, not truncated.
+  for (size_t i = 0; i < num_files; ++i) {
+    CHECK(ReadFile("temp/pool" + std::to_string(i) + ".txt") == "0\n1\n2\n");
+  }
+}
+
+TEST_CASE("OutputPool_Buffering", "[Emplode]"){
+  {
+    emplode::OutputPool pool;
+    pool.SetBufferSize(1000);
+    pool.Write("temp/buffered.txt", "first\n");
+    CHECK(pool.Has("temp/buffered.txt"));
+    CHECK(!pool.Has("temp/other.txt"));
+    CHECK(pool.GetNumOpens() == 0);     // Nothing written yet.
+
+    pool.Flush("temp/buffered.txt");
+    CHECK(ReadFile("temp/buffered.txt") == "first\n");
+    pool.Write("temp/buffered.txt", "second\n");
+    CHECK(ReadFile("temp/buffered.txt") == "first\n");
+  }
+  // Destruction flushes everything left.
+  CHECK(ReadFile("temp/buffered.txt") == "first\nsecond\n");
+}
+
+TEST_CASE("OutputPool_DataFile", "[Emplode]"){
+  emp::StreamManager files;
+  files.SetOutputDefaultFile();
+  {
+    emplode::OutputPool pool;
+    pool.SetMaxOpen(2);
+    pool.SetBufferSize(1);
+
+    emp::vector<emplode::DataFile> data_files;
+    double value = 0.0;
+    for (size_t i = 0; i < 5; ++i) {
+      data_files.emplace_back("df" + std::to_string(i), files, &pool);
+      data_files.back().SetFilename("temp/df" + std::to_string(i) + ".csv");
+      data_files.back().AddColumn("id", [i](){ return emp::Datum(i * 1.0); });
+      data_files.back().AddColumn("value", [&value](){ return emp::Datum(value); });
+    }
+    for (size_t update = 0; update < 3; ++update) {
+      value = update * 1.5;
+      for (auto & df : data_files) df.Write();
+    }
+    CHECK(pool.GetNumOpen() <= 2);
+  }
+
+  CHECK(ReadFile("temp/df3.csv") == "id,value\n3,0\n3,1.5\n3,3\n");
+  CHECK(!files.Has("temp/df3.csv"));    // Pooled files bypass the stream manager.
+}
+
+TEST_CASE("OutputPool_FlushOnExit", "[Emplode]"){
+  // exit() skips the destructors of local pools, but buffered text is still written.
+  CHECK(RunInChild([](){
+    emplode::OutputPool pool;
+    pool.Write("temp/exit.txt", "kept\n");
+    exit(1);
+  }).first == 1);
+  CHECK(ReadFile("temp/exit.txt") == "kept\n");
+
+  // Rows written before a script error are kept.
+  CHECK(RunInChild([](){
+    emplode::Emplode emplode;
+    emplode.SetStepLimit(1000);
+    emplode.LoadStatements(
+      "DataFile f { filename = \"temp/exit.csv\"; };"
+      "f.ADD_COLUMN(\"x\", \"1\"); f.WRITE(); f.WRITE();"
+      "WHILE (1) { }", "exit_test");
+  }).first == 1);
+  CHECK(ReadFile("temp/exit.csv") == "x\n1\n1\n");
+}
@@ -0,0 +1,73 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  OutputSink.cpp
+ *  @brief Tests for redirectable PRINT output and PRINTF formatting.
+ */
+
+#include <fstream>
+#include <sstream>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/OutputSink.hpp"
+
+TEST_CASE("OutputSink_Targets", "[Emplode]"){
+  emplode::OutputSink sink;
+
+  std::stringstream ss;
+  sink.SetStream(ss);
+  CHECK(!sink.IsLineBuffered());
+  sink.Write("to stream\n");
+  CHECK(ss.str() == "to stream\n");
+
+  sink.SetString();
+  sink.Write("to ");
+  sink.Write("string\n");
+  CHECK(sink.GetString() == "to string\n");
+  sink.ClearString();
+  CHECK(sink.GetString() == "");
+
+  sink.SetFile("temp/print.txt");
+  sink.Write("to file\n");
+  sink.Flush();
+  std::stringstream file_text;
+  file_text << std::ifstream("temp/print.txt").rdbuf();
+  CHECK(file_text.str() == "to file\n");
+}
+
+TEST_CASE("OutputSink_Print", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.GetPrintSink().SetString();
+
+  emplode.Execute("{ Var x = 2.5; Var s = \"abc\"; PRINT(\"x=\", x, \" s=\", s, \" \", [1, 2]); }");
+  CHECK(emplode.GetPrintSink().GetString() == "x=2.5 s=abc [1, 2]\n");
+
+  emplode.GetPrintSink().ClearString();
+  emplode.Execute("PRINT(1.0/3.0, \" \", 1000000 * 1000000)");
+  CHECK(emplode.GetPrintSink().GetString() == "0.333333 1e+12\n");
+}
+
+TEST_CASE("OutputSink_Printf", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.GetPrintSink().SetString();
+  auto & out = emplode.GetPrintSink();
+
+  CHECK(emplode.Execute("PRINTF(\"%d|%5.2f|%-4s|%x|%%\", 42.7, 3.14159, \"ab\", 255)").AsDouble() == 18);
+  CHECK(out.GetString() == "42| 3.14|ab  |ff|%");
+
+  out.ClearString();
+  emplode.Execute("PRINTF(\"%s and %c%c: %e %g\", [1,2], \"xyz\", 65, 12345.678, 0.0001)");
+  CHECK(out.GetString() == "[1, 2] and xA: 1.234568e+04 0.0001");
+
+  // Long output does not fit the small formatting buffer.
+  out.ClearString();
+  emplode.Execute("PRINTF(\"%100s\", \"end\")");
+  CHECK(out.GetString().size() == 100);
+  CHECK(out.GetString().substr(97) == "end");
+}
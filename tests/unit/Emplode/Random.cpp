@@ -0,0 +1,170 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Random.cpp
+ *  @brief Tests for the random number generator and random built-in functions.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <string>
+#include <thread>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/Random.hpp"
+
+#include "ChildProcess.hpp"
+
+TEST_CASE("Random_Generator", "[Emplode]"){
+  // Reference values from an independent implementation of SplitMix64 seeding + xoshiro256**.
+  emplode::Random random(42);
+  CHECK(random.GetUInt64() == 13696896915399030466ull);
+  CHECK(random.GetUInt64() == 12641092763546669283ull);
+  CHECK(random.GetUInt64() == 14580102322132234639ull);
+
+  // Streams are independent; reseeding restarts a stream.
+  emplode::Random random2(42, 1);
+  CHECK(random2.GetUInt64() == 15553753696617909805ull);
+  random.ResetSeed(42);
+  CHECK(random.GetUInt64() == 13696896915399030466ull);
+
+  // Distributions have the expected ranges and (roughly) the expected moments.
+  const size_t N = 100000;
+  double sum = 0.0, normal_sum = 0.0, normal_sq = 0.0, pois_small = 0.0, pois_large = 0.0;
+  double min_x = 10.0, max_x = 0.0;
+  int64_t min_k = 10, max_k = -10;
+  for (size_t i = 0; i < N; ++i) {
+    const double x = random.GetDouble(2.0, 4.0);
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+    sum += x;
+    const int64_t k = random.GetInt(-3, 3);
+    min_k = std::min(min_k, k);
+    max_k = std::max(max_k, k);
+    const double n = random.GetNormal(5.0, 2.0);
+    normal_sum += n;
+    normal_sq += n * n;
+    pois_small += random.GetPoisson(3.5);
+    pois_large += random.GetPoisson(250.0);
+  }
+  CHECK(min_x >= 2.0);
+  CHECK(max_x < 4.0);
+  CHECK(min_k == -3);
+  CHECK(max_k == 2);
+  CHECK(sum / N == Approx(3.0).epsilon(0.01));
+  const double normal_mean = normal_sum / N;
+  CHECK(normal_mean == Approx(5.0).epsilon(0.01));
+  CHECK(std::sqrt(normal_sq / N - normal_mean * normal_mean) == Approx(2.0).epsilon(0.02));
+  CHECK(pois_small / N == Approx(3.5).epsilon(0.02));
+  CHECK(pois_large / N == Approx(250.0).epsilon(0.01));
+}
+
+TEST_CASE("Random_Builtins", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.SetRandomSeed(7);
+
+  double value = emplode.Execute("RANDOM()").AsDouble();
+  CHECK(value >= 0.0);
+  CHECK(value < 1.0);
+  value = emplode.Execute("RANDOM_INT(10, 20)").AsDouble();
+  CHECK(value >= 10.0);
+  CHECK(value < 20.0);
+  CHECK(value == std::floor(value));
+
+  // List-returning variants produce N draws in a single call, repeatable with the same seed.
+  emplode.Execute("Var draws = NORMAL(0, 1, 50)");
+  emplode::Emplode emplode2;
+  emplode2.SetRandomSeed(7);
+  emplode2.Execute("RANDOM()");
+  emplode2.Execute("RANDOM_INT(10, 20)");
+  emplode2.Execute("Var draws = NORMAL(0, 1, 50)");
+  std::set<double> draws;
+  for (size_t i = 0; i < 50; ++i) {
+    const std::string draw = "draws[" + std::to_string(i) + "]";
+    CHECK(emplode.Execute(draw).AsDouble() == emplode2.Execute(draw).AsDouble());
+    draws.insert(emplode.Execute(draw).AsDouble());
+  }
+  CHECK(draws.size() == 50);    // Each draw is distinct.
+  emplode.Execute("Var ints = RANDOM_INT(0, 3, 200)");
+  std::set<double> seen;
+  for (size_t i = 0; i < 200; ++i) {
+    seen.insert(emplode.Execute("ints[" + std::to_string(i) + "]").AsDouble());
+  }
+  CHECK(seen == std::set<double>{0.0, 1.0, 2.0});
+
+  // CHOOSE with a count picks distinct elements; SHUFFLE keeps all of them.
+  emplode.Execute("Var base = [1, 2, 3, 4, 5]");
+  emplode.Execute("Var picks = CHOOSE(base, 5)");
+  emplode.Execute("Var mixed = SHUFFLE(base)");
+  std::set<double> picks, mixed;
+  for (size_t i = 0; i < 5; ++i) {
+    picks.insert(emplode.Execute("picks[" + std::to_string(i) + "]").AsDouble());
+    mixed.insert(emplode.Execute("mixed[" + std::to_string(i) + "]").AsDouble());
+  }
+  CHECK(picks.size() == 5);
+  CHECK(mixed.size() == 5);
+  CHECK(emplode.Execute("base[0]").AsDouble() == 1.0);  // Original list is untouched.
+
+  // The same seed gives the same results; other stream ids give other sequences.
+  emplode.Execute("SET_RANDOM_SEED(11)");
+  const double first = emplode.Execute("RANDOM()").AsDouble();
+  emplode.Execute("SET_RANDOM_SEED(11)");
+  CHECK(emplode.Execute("RANDOM()").AsDouble() == first);
+
+  emplode::Emplode other;
+  other.SetRandomSeed(11, 1);
+  CHECK(other.Execute("RANDOM()").AsDouble() != first);
+
+  // Choosing no elements always works, even from an empty list.
+  emplode.Execute("Var none = CHOOSE([], 0)");
+  auto none = emplode.GetSymbolTable().GetRootScope().GetSymbol("none")->GetValue();
+  REQUIRE(none->IsList());
+  CHECK(none.DynamicCast<emplode::Symbol_List>()->GetValues().size() == 0);
+}
+
+// The default stream does not depend on how many instances exist or where they were made.
+TEST_CASE("Random_DefaultStream", "[Emplode]"){
+  emplode::Emplode first;
+  const double expected = first.Execute("RANDOM()").AsDouble();
+
+  double on_thread = 0.0;
+  std::thread worker([&on_thread](){
+    emplode::Emplode extra;
+    emplode::Emplode mine;
+    on_thread = mine.Execute("RANDOM()").AsDouble();
+  });
+  worker.join();
+  CHECK(on_thread == expected);
+
+  emplode::Emplode seeded;
+  seeded.SetRandomSeed(0, 0);
+  CHECK(seeded.Execute("RANDOM()").AsDouble() == expected);
+}
+
+// Load statements in a child process; return its exit status and anything written to stderr.
+static std::pair<int, std::string> LoadInChild(const std::string & statements) {
+  return RunInChild([&statements](){
+    emplode::Emplode emplode;
+    emplode.LoadStatements(statements, "child");
+  });
+}
+
+TEST_CASE("Random_EmptyRange", "[Emplode]"){
+  // A range with no integers in it is a user error (not just an assert).
+  auto [status, err] = LoadInChild("RANDOM_INT(1.2, 1.8);");
+  CHECK(status == 1);
+  CHECK(err.find("RANDOM_INT range [1.2,1.8) has no integers") != std::string::npos);
+
+  std::tie(status, err) = LoadInChild("RANDOM_INT(5, 5);");
+  CHECK(status == 1);
+
+  std::tie(status, err) = LoadInChild("RANDOM_INT(1.2, 2.5);");   // Only 2 is in range.
+  CHECK(status == 0);
+}
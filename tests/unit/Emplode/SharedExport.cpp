@@ -0,0 +1,162 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  SharedExport.cpp
+ *  @brief Tests for exporting live values through shared memory.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/DataFile.hpp"
+#include "Emplode/SharedExport.hpp"
+
+#include "ChildProcess.hpp"
+
+TEST_CASE("SharedExport_Basic", "[Emplode]"){
+  const std::string segment = "/emplode_test_basic_" + std::to_string(getpid());
+  int update = 0;
+  double fitness = 0.5;
+
+  emplode::SharedExport exporter(segment);
+  exporter.AddVar("update", update);
+  exporter.AddVar("fitness", fitness);
+  exporter.AddValue("twice", [&fitness](){ return 2.0 * fitness; });
+
+  emplode::SharedReader reader;
+  CHECK(!reader.Open(segment));         // Not created until opened or first published.
+
+  exporter.Publish();
+  REQUIRE(reader.Open(segment));
+  CHECK(reader.GetNumValues() == 3);
+  CHECK(std::string(reader.GetName(1)) == "fitness");
+  CHECK(reader.GetNumUpdates() == 1);
+  CHECK(reader.GetValue(2) == 1.0);
+
+  update = 7;
+  fitness = 3.25;
+  exporter.Publish();
+  emp::vector<double> values;
+  CHECK(reader.Read(values) == 2);
+  CHECK(values == emp::vector<double>{7.0, 3.25, 6.5});
+
+  exporter.Close();
+  emplode::SharedReader late_reader;
+  CHECK(!late_reader.Open(segment));
+}
+
+// A reader in a separate process must only ever see complete updates.
+TEST_CASE("SharedExport_Processes", "[Emplode]"){
+  const std::string segment = "/emplode_test_proc_" + std::to_string(getpid());
+  constexpr size_t NUM_VALUES = 64;
+  constexpr uint64_t NUM_UPDATES = 200000;
+
+  emplode::SharedExport exporter(segment);
+  for (size_t i = 0; i < NUM_VALUES; ++i) exporter.AddValue("v" + std::to_string(i));
+  emp::vector<double> row(NUM_VALUES, 0.0);
+  exporter.Publish(row);
+
+  const pid_t child = fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    // Reader: every value in a snapshot must come from the same update.
+    emplode::SharedReader reader;
+    if (!reader.Open(segment)) _exit(2);
+    emp::vector<double> values;
+    uint64_t last = 0;
+    size_t num_reads = 0;
+    while (last < NUM_UPDATES) {
+      const uint64_t update = reader.Read(values);
+      if (update < last) _exit(3);
+      for (size_t i = 0; i < NUM_VALUES; ++i) {
+        if (values[i] != static_cast<double>(update - 1) * (i + 1)) _exit(4);
+      }
+      last = update;
+      ++num_reads;
+    }
+    _exit(num_reads > 0 ? 0 : 5);
+  }
+
+  for (uint64_t update = 1; update < NUM_UPDATES; ++update) {
+    for (size_t i = 0; i < NUM_VALUES; ++i) row[i] = static_cast<double>(update) * (i + 1);
+    exporter.Publish(row);
+  }
+
+  int status = 0;
+  waitpid(child, &status, 0);
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == 0);
+}
+
+// A segment owned by a live process must not be taken over.
+TEST_CASE("SharedExport_Collision", "[Emplode]"){
+  const std::string segment = "/emplode_test_collide_" + std::to_string(getpid());
+  emplode::SharedExport first(segment);
+  first.AddValue("a");
+  REQUIRE(first.Open());
+
+  emplode::SharedExport second(segment);
+  second.AddValue("b");
+  std::stringstream errors;
+  std::streambuf * old_cerr = std::cerr.rdbuf(errors.rdbuf());
+  const bool opened = second.Open();
+  std::cerr.rdbuf(old_cerr);
+  CHECK(!opened);
+  CHECK(errors.str().find("already in use") != std::string::npos);
+
+  // The original segment is untouched.
+  emplode::SharedReader reader;
+  REQUIRE(reader.Open(segment));
+  CHECK(std::string(reader.GetName(0)) == "a");
+}
+
+// A segment left behind by a process that died is replaced.
+TEST_CASE("SharedExport_Stale", "[Emplode]"){
+  const std::string segment = "/emplode_test_stale_" + std::to_string(getpid());
+  auto [status, err] = RunInChild([&segment](){
+    emplode::SharedExport exporter(segment);
+    exporter.AddValue("old");
+    _exit(exporter.Open() ? 0 : 1);     // Exit without running the destructor.
+  });
+  REQUIRE(status == 0);
+
+  emplode::SharedExport exporter(segment);
+  exporter.AddValue("new");
+  exporter.AddValue("newer");
+  REQUIRE(exporter.Open());
+  emplode::SharedReader reader;
+  REQUIRE(reader.Open(segment));
+  CHECK(reader.GetNumValues() == 2);
+  CHECK(std::string(reader.GetName(0)) == "new");
+}
+
+TEST_CASE("SharedExport_DataFile", "[Emplode]"){
+  emp::StreamManager files;
+  emplode::DataFile df("live", files);
+  df.SetBackend(emplode::DataFile::Backend::SHARED);
+  df.SetFilename("emplode_test_df_" + std::to_string(getpid()));
+
+  double size = 10.0;
+  df.AddColumn("size", [&size](){ return size; });
+  df.AddColumn("label", [](){ return std::string("abc"); });
+  df.Write();
+  size = 12.0;
+  df.Write();
+
+  emplode::SharedReader reader;
+  REQUIRE(reader.Open(df.GetFilename()));
+  CHECK(reader.GetNumUpdates() == 2);
+  CHECK(reader.GetValue(0) == 12.0);
+  CHECK(std::isnan(reader.GetValue(1)));
+}
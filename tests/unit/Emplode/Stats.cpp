@@ -0,0 +1,77 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Stats.cpp
+ *  @brief Tests for the list statistics functions.
+ */
+
+#include <cmath>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/Stats.hpp"
+
+// Reference values computed with Python's statistics module (pvariance, pstdev, median,
+// quantiles with method='inclusive', correlation).
+TEST_CASE("Stats_Reference", "[Emplode]"){
+  const emp::vector<double> x{ 2.5, 7.25, 1.0, 9.5, 4.0, 4.0, 6.75, 3.125, 8.0, 5.5 };
+  const emp::vector<double> y{ 1.0, 3.0, 0.5, 4.5, 2.0, 2.5, 3.25, 1.5, 4.0, 2.75 };
+
+  CHECK(emplode::Stats::Mean(x) == Approx(5.1625));
+  CHECK(emplode::Stats::Variance(x) == Approx(6.51265625));
+  CHECK(emplode::Stats::StdDev(x) == Approx(2.551990644575328));
+
+  emp::vector<double> work = x;
+  CHECK(emplode::Stats::Median(work) == 4.75);
+  work = x;
+  CHECK(emplode::Stats::Quantile(work, 0.25) == Approx(3.34375));
+  work = x;
+  CHECK(emplode::Stats::Quantile(work, 0.9) == Approx(8.15));
+  work = x;
+  CHECK(emplode::Stats::Quantile(work, 0.0) == 1.0);
+  work = x;
+  CHECK(emplode::Stats::Quantile(work, 1.0) == 9.5);
+
+  work = x;
+  CHECK(emplode::Stats::Entropy(work) == Approx(3.121928094887362));
+  CHECK(emplode::Stats::Correlation(x, y) == Approx(0.978138003332378));
+
+  CHECK(emplode::Stats::Histogram(x, 4) == emp::vector<double>{2, 3, 3, 2});
+  CHECK(emplode::Stats::Histogram(x, 3, 0.0, 6.0) == emp::vector<double>{1, 2, 3});
+
+  // Large offsets would lose all precision with a sum-of-squares formula.
+  const emp::vector<double> offset{ 1e9+4, 1e9+7, 1e9+13, 1e9+16 };
+  CHECK(emplode::Stats::Variance(offset) == Approx(22.5));
+
+  // Empty input.
+  CHECK(std::isnan(emplode::Stats::Mean(emp::vector<double>{})));
+  work.clear();
+  CHECK(std::isnan(emplode::Stats::Median(work)));
+  CHECK(emplode::Stats::Entropy(work) == 0.0);
+}
+
+TEST_CASE("Stats_Builtins", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.Execute("Var x = [2.5, 7.25, 1.0, 9.5, 4.0, 4.0, 6.75, 3.125, 8.0, 5.5]");
+  emplode.Execute("Var y = [1.0, 3.0, 0.5, 4.5, 2.0, 2.5, 3.25, 1.5, 4.0, 2.75]");
+
+  CHECK(emplode.Execute("MEAN(x)").AsDouble() == Approx(5.1625));
+  CHECK(emplode.Execute("VARIANCE(x)").AsDouble() == Approx(6.51265625));
+  CHECK(emplode.Execute("STDDEV(x)").AsDouble() == Approx(2.551990644575328));
+  CHECK(emplode.Execute("MEDIAN(x)").AsDouble() == 4.75);
+  CHECK(emplode.Execute("QUANTILE(x, 0.9)").AsDouble() == Approx(8.15));
+  CHECK(emplode.Execute("ENTROPY(x)").AsDouble() == Approx(3.121928094887362));
+  CHECK(emplode.Execute("CORRELATION(x, y)").AsDouble() == Approx(0.978138003332378));
+
+  // The input list is not reordered by selection.
+  CHECK(emplode.Execute("x[1]").AsDouble() == 7.25);
+
+  emplode.Execute("Var hist = HISTOGRAM(x, 3, 0, 6)");
+  CHECK(emplode.Execute("hist[0]").AsDouble() == 1.0);
+  CHECK(emplode.Execute("hist[2]").AsDouble() == 3.0);
+}
@@ -15,3 +15,30 @@
 
 
 TEST_CASE("Symbol_Placeholder", "[Emplode]"){ ; }
+
+TEST_CASE("Symbol_Metadata", "[Emplode]"){
+  // Unnamed symbols carry no name or description.
+  emplode::Symbol_Var temp(5.0);
+  CHECK(temp.GetName() == "");
+  CHECK(temp.GetDesc() == "");
+
+  emplode::Symbol_Var var("x", 1.0, "An important value");
+  CHECK(var.GetName() == "x");
+  CHECK(var.GetDesc() == "An important value");
+
+  // Copies get their own name and metadata.
+  emplode::Symbol_Var copy(var);
+  var.SetName("y").SetDesc("Changed");
+  CHECK(copy.GetName() == "x");
+  CHECK(copy.GetDesc() == "An important value");
+  CHECK(var.GetDesc() == "Changed");
+
+  temp = copy;
+  CHECK(temp.GetName() == "x");
+  CHECK(temp.GetDesc() == "An important value");
+  CHECK(temp.AsDouble() == 1.0);
+
+  // A symbol holds only pointers to its name and metadata plus a few flags; everything else
+  // is out of line.
+  CHECK(sizeof(emplode::Symbol_Var) <= sizeof(emp::Datum) + 5 * sizeof(void*));
+}
@@ -0,0 +1,68 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Symbol_Menu.cpp
+ *  @brief Tests for menu settings and their name lookup.
+ */
+
+#include <sstream>
+#include <string>
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/Symbol_Menu.hpp"
+
+enum class MenuTestShape { CIRCLE, SQUARE, TRIANGLE };
+
+struct MenuTestObj : public emplode::EmplodeType {
+  MenuTestShape shape = MenuTestShape::SQUARE;
+
+  void SetupConfig() override {
+    LinkMenu(shape, "shape", "Shape to draw.",
+             MenuTestShape::CIRCLE, "circle", "Round.",
+             MenuTestShape::SQUARE, "square", "Four sides.",
+             MenuTestShape::TRIANGLE, "triangle", "Three sides.");
+  }
+};
+
+TEST_CASE("Symbol_Menu_Names", "[Emplode]"){
+  emp::vector<std::string> names;
+  for (size_t i = 0; i < 50; ++i) names.push_back("option" + std::to_string(i));
+  emplode::MenuNames menu(names);
+  CHECK(menu.GetSize() == 50);
+  for (size_t i = 0; i < 50; ++i) CHECK(menu.Find(names[i]) == static_cast<int>(i));
+  CHECK(menu.Find("option50") == -1);
+  CHECK(menu.Find("") == -1);
+
+  emplode::MenuNames empty({});
+  CHECK(empty.Find("anything") == -1);
+}
+
+TEST_CASE("Symbol_Menu_Emplode", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddType<MenuTestObj>("MenuTestObj", "Object with a menu setting");
+  emplode.LoadStatements("MenuTestObj obj { shape = \"triangle\"; }; Var saved = obj.shape;", "test");
+
+  CHECK(emplode.Execute("obj.shape").AsString() == "triangle");
+  CHECK(emplode.Execute("obj.shape == \"triangle\"").AsDouble() == 1.0);
+
+  // Assignment updates the C++ variable; changes made in C++ are seen by scripts.
+  emplode.Execute("obj.shape = \"circle\"");
+  auto & obj = emplode.GetSymbolTable().GetRootScope().GetSymbol("obj")->GetValue()->As<MenuTestObj &>();
+  CHECK(obj.shape == MenuTestShape::CIRCLE);
+  obj.shape = MenuTestShape::SQUARE;
+  CHECK(emplode.Execute("obj.shape").AsString() == "square");
+
+  // Copies hold the option name rather than following the setting.
+  CHECK(emplode.Execute("saved").AsString() == "triangle");
+
+  // The setting is written to config files by name.
+  std::stringstream ss;
+  emplode.GetSymbolTable().GetRootScope().GetSymbol("obj")->GetValue()->AsScope().WriteContents(ss);
+  CHECK(ss.str().find("shape = \"square\";") != std::string::npos);
+}
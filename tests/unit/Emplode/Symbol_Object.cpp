@@ -1,17 +1,47 @@
 /**
  *  @note This file is part of MABE, https://github.com/mercere99/MABE2
  *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
- *  @date 2019-2021.
+ *  @date 2019-2022.
  *
  *  @file  Symbol_Object.cpp
- *  @brief TODO. Currently this is a placeholder so codecov will see the untested source code
+ *  @brief Tests for symbols that hold script objects.
  */
 
 // CATCH
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 // MABE
+#include "Emplode/Emplode.hpp"
 #include "Emplode/Symbol_Object.hpp"
 
+struct ObjTestBase : public emplode::EmplodeType {
+  double total = 0.0;
+};
+
+struct ObjTestDerived : public ObjTestBase {
+  static void InitType(emplode::TypeInfo & info) {
+    info.AddMemberFunction("Add", [](ObjTestDerived & obj, double x) { return obj.total += x; },
+                           "Add to the total.");
+  }
+};
 
 TEST_CASE("Symbol_Object_Placeholder", "[Emplode]"){ ; }
+
+TEST_CASE("Symbol_Object_As", "[Emplode]"){
+  emplode::Emplode emplode;
+  emplode.AddType<ObjTestDerived>("ObjTestDerived", "Test object");
+  emplode.AddFunction("Total", [](ObjTestBase & obj) { return obj.total; }, "Total of any test object");
+  emplode.LoadStatements("ObjTestDerived obj; obj.Add(2); obj.Add(3);", "test");
+
+  emplode::Symbol & symbol = *emplode.GetSymbolTable().GetRootScope().GetSymbol("obj")->GetValue();
+  CHECK(symbol.HasObjectType<ObjTestDerived>());
+  CHECK(!symbol.HasObjectType<ObjTestBase>());
+
+  // The registered type converts directly; a base type is found through a dynamic cast.
+  ObjTestDerived & derived = symbol.As<ObjTestDerived &>();
+  ObjTestBase & base = symbol.As<ObjTestBase &>();
+  CHECK(&derived == symbol.GetObjectPtr().Raw());
+  CHECK(&base == &derived);
+  CHECK(derived.total == 5.0);
+  CHECK(emplode.Execute("Total(obj)").AsDouble() == 5.0);
+}
@@ -0,0 +1,39 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  ThreadPool.cpp
+ *  @brief Tests for the fixed-size worker pool used to evaluate DataFile columns in parallel.
+ */
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/ThreadPool.hpp"
+
+TEST_CASE("ThreadPool_ParallelFor", "[Emplode]"){
+  emplode::ThreadPool pool(4);
+  CHECK(pool.GetNumThreads() == 4);
+
+  emp::vector<size_t> out(1000, 0);
+  for (size_t batch = 1; batch <= 20; ++batch) {
+    pool.ParallelFor(out.size(), [&out](size_t i){ out[i] += i; });
+  }
+  for (size_t i = 0; i < out.size(); ++i) CHECK(out[i] == 20 * i);
+
+  // An empty batch returns right away.
+  pool.ParallelFor(0, [&out](size_t i){ out[i] = 0; });
+  CHECK(out[999] == 20 * 999);
+}
+
+TEST_CASE("ThreadPool_SingleThread", "[Emplode]"){
+  // A pool of one runs everything on the calling thread.
+  emplode::ThreadPool pool(1);
+  CHECK(pool.GetNumThreads() == 1);
+
+  emp::vector<size_t> order;
+  pool.ParallelFor(5, [&order](size_t i){ order.push_back(i); });
+  CHECK(order == emp::vector<size_t>{0, 1, 2, 3, 4});
+}
@@ -0,0 +1,70 @@
+/**
+ *  @note This file is part of MABE, https://github.com/mercere99/MABE2
+ *  @copyright Copyright (C) Michigan State University, MIT Software license; see doc/LICENSE.md
+ *  @date 2022.
+ *
+ *  @file  Value.cpp
+ *  @brief Tests for ownership of evaluation results.
+ */
+
+// CATCH
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+// MABE
+#include "Emplode/Emplode.hpp"
+#include "Emplode/Value.hpp"
+
+TEST_CASE("Value_Ownership", "[Emplode]"){
+  emplode::Symbol_Var named("x", 1.0, "", nullptr);
+
+  // Borrowed symbols are never deleted; detaching them makes a copy.
+  {
+    emplode::Value borrowed(&named);
+    CHECK(borrowed);
+    CHECK(!borrowed.IsOwned());
+    emp::Ptr<emplode::Symbol> copy = borrowed.Detach();
+    CHECK(copy != emp::Ptr<emplode::Symbol>(&named));
+    CHECK(copy->AsDouble() == 1.0);
+    CHECK(!copy->IsTemporary());
+    CHECK(!borrowed);
+    copy.Delete();
+  }
+
+  // Temporaries are owned and can be moved, released, or detached.
+  auto temp = emp::NewPtr<emplode::Symbol_Var>("", 2.0, "", nullptr);
+  temp->SetTemporary();
+  emplode::Value owned(temp);
+  CHECK(owned.IsOwned());
+  emplode::Value moved(std::move(owned));
+  CHECK(!owned);
+  CHECK(moved.Get() == emp::Ptr<emplode::Symbol>(temp));
+  emp::Ptr<emplode::Symbol> released = moved.Release();
+  CHECK(released == emp::Ptr<emplode::Symbol>(temp));
+  CHECK(released->IsTemporary());
+  emplode::Value again(released);
+  CHECK(again.Detach() == emp::Ptr<emplode::Symbol>(temp));
+  CHECK(!temp->IsTemporary());
+  temp.Delete();
+
+  // A symbol inside a temporary keeps the temporary alive.
+  auto list = emp::NewPtr<emplode::Symbol_List>();
+  list->SetTemporary();
+  auto entry = emp::NewPtr<emplode::Symbol_Var>("", 3.0, "", nullptr);
+  list->Push(entry);
+  emplode::Value member(entry, emplode::Value(list));
+  CHECK(!member.IsOwned());
+  CHECK(member->AsDouble() == 3.0);
+  emp::Ptr<emplode::Symbol> kept = member.Release();   // Cloned, since the list is now freed.
+  CHECK(kept != emp::Ptr<emplode::Symbol>(entry));
+  CHECK(kept->IsTemporary());
+  CHECK(kept->AsDouble() == 3.0);
+  kept.Delete();
+}
+
+TEST_CASE("Value_Execute", "[Emplode]"){
+  emplode::Emplode emplode;
+  CHECK(emplode.Execute("[1, 2, 3].pop()").AsDouble() == 3.0);
+  CHECK(emplode.Execute("[4, 5, 6][1]").AsDouble() == 5.0);
+  emplode.Execute("{ Var f(x) { RETURN [x, x * 2][1]; }; Var y = f(4); }");
+  CHECK(emplode.Execute("y").AsDouble() == 8.0);
+}